@@ -0,0 +1,234 @@
+// Benchmark suite of the hull algorithms. It replaces the old PERF block of convex_hull.cpp : wall-clock
+// time (steady_clock), warmup runs, sizes from 1e3 to 1e8 points, and median / p90 / p99 / max per
+// algorithm and per dataset. Results can be written as CSV and JSON to compare builds.
+// The percentiles are nearest rank ones : with fewer than 100 runs the p99 is the max (and with fewer
+// than 10 runs the p90 too), so it only tells more than the max with --runs 100 or more and a budget
+// that allows them.
+//
+// Usage : ./benchmark [options]
+//     --sizes 1e3,1e4,...      sizes to run (default : every power of ten from 1e3 to 1e8)
+//     --datasets ABCD          datasets to run, among A to H (default : ABCD)
+//     --algorithms a,b,...     algorithms to run (default : all of them, see ALGORITHMS below)
+//     --runs N                 maximal number of timed runs per configuration (default : 15)
+//     --warmup N               number of untimed runs before timing (default : 2)
+//     --budget S               seconds of timed runs per configuration, fewer runs if needed (default : 2)
+//     --threads N              threads of the parallel algorithms (default : all cores)
+//     --seed N                 seed of the generators (default : 1)
+//     --prefilter              runs the Akl-Toussaint prefilter before every algorithm (timed)
+//     --csv file, --json file  also writes the results in these files
+//
+// Built with -DHULL_STATS (make perf_stats), it also prints the phase times and the counters of
+// convex_hull.h, averaged over the timed runs.
+
+#define CONVEX_HULL_LIBRARY // Everything but the main() of convex_hull.cpp
+#include "convex_hull.cpp"
+
+using wall_clock = chrono::steady_clock;
+
+struct bench_config{
+    vector<long long> sizes;
+    string datasets="ABCD";
+    vector<string> algorithms;
+    int runs=15;
+    int warmup=2;
+    double budget=2;
+    int threads=thread::hardware_concurrency();
+    unsigned seed=1;
+    bool prefilter=false;
+    string csv, json;
+};
+
+struct bench_result{
+    string algorithm;
+    char dataset=0;
+    long long size=0;
+    int runs=0;
+    double median=0, p90=0, p99=0, max=0, min=0, mean=0; // In seconds
+    size_t hull_size=0;
+    long long fallbacks=0; // Exact evaluations of the predicates per run
+    hull_stats stats;      // Sum over the timed runs
+};
+
+using hull_algorithm = function<vector<point>(vector<point>&, int)>;
+
+const vector<pair<string, hull_algorithm>> ALGORITHMS={
+    {"sweep", [](vector<point>& p, int){ return convex_hull_sweeping(p); }},
+    {"sweep_parallel", [](vector<point>& p, int threads){ return convex_hull_sweeping_parallel(p, threads); }},
+    {"dnc", [](vector<point>& p, int){ Algorithm2 tmp(p); return tmp.startAlgorithm(); }},
+    {"dnc_in_place", [](vector<point>& p, int){ Algorithm2 tmp(p); return tmp.startAlgorithmInPlace(); }},
+    {"dnc_parallel", [](vector<point>& p, int threads){ Algorithm2 tmp(p); return tmp.startAlgorithmParallel(threads); }},
+    {"chan", [](vector<point>& p, int){ return convex_hull_chan(p); }},
+    {"quickhull", [](vector<point>& p, int threads){ return convex_hull_quickhull(p, threads); }},
+};
+
+double percentile(const vector<double>& sorted, double q){
+    // Nearest-rank percentile
+    int rank=(int)ceil(q*sorted.size());
+    return sorted[max(0, rank-1)];
+}
+
+bench_result run(const string& name, const hull_algorithm& algorithm, char dataset, const vector<point>& data, const bench_config& config){
+    // The input is copied before every run, outside of the timed region
+    hull_stats stats;
+    auto timed_run=[&](double& time, size_t& hull_size){
+        vector<point> input{ data };
+        reset_stats();
+        auto start=wall_clock::now();
+        if (config.prefilter) akl_toussaint_filter(input, config.threads);
+        hull_size=algorithm(input, config.threads).size();
+        time=chrono::duration<double>(wall_clock::now()-start).count();
+        stats+=read_stats();
+    };
+    double time=0;
+    size_t hull_size=0;
+    // Long runs need less warmup : stop as soon as the warmup takes a good part of the budget
+    double warmup_time=0;
+    for (int i=0; i<config.warmup && warmup_time<config.budget/2; i++){
+        timed_run(time, hull_size);
+        warmup_time+=time;
+    }
+    int runs=config.runs;
+    if (config.warmup>0) runs=max(3, min(runs, (int)(config.budget/max(time, 1e-9))));
+
+    vector<double> times;
+    stats=hull_stats();
+    long long fallbacks=-orient_fallbacks;
+    forn(i,runs){
+        timed_run(time, hull_size);
+        times.push_back(time);
+    }
+    fallbacks+=orient_fallbacks;
+    sort(all(times));
+    bench_result res;
+    res.algorithm=name;
+    res.dataset=dataset;
+    res.size=data.size();
+    res.runs=runs;
+    res.median=percentile(times, 0.5);
+    res.p90=percentile(times, 0.9);
+    res.p99=percentile(times, 0.99);
+    res.max=times.back();
+    res.min=times[0];
+    res.mean=accumulate(all(times), 0.)/runs;
+    res.hull_size=hull_size;
+    res.fallbacks=fallbacks/runs;
+    res.stats=stats;
+    return res;
+}
+
+void write_csv(const string& filename, const vector<bench_result>& results){
+    ofstream out(filename);
+    out<<"algorithm,dataset,size,runs,median_s,p90_s,p99_s,max_s,min_s,mean_s,hull_size,fallbacks_per_run\n";
+    out<<setprecision(9);
+    for (const auto& r : results){
+        out<<r.algorithm<<","<<r.dataset<<","<<r.size<<","<<r.runs<<","<<r.median<<","<<r.p90<<","<<r.p99<<","<<r.max<<",";
+        out<<r.min<<","<<r.mean<<","<<r.hull_size<<","<<r.fallbacks<<"\n";
+    }
+}
+
+void write_json(const string& filename, const vector<bench_result>& results, const bench_config& config){
+    ofstream out(filename);
+    out<<setprecision(9);
+    out<<"{\n  \"build\": {\"compiler\": \"" __VERSION__ "\", \"prefilter\": "<<(config.prefilter ? "true" : "false");
+    out<<", \"threads\": "<<config.threads<<", \"seed\": "<<config.seed<<"},\n  \"results\": [\n";
+    forn(i,(int)results.size()){
+        const auto& r=results[i];
+        out<<"    {\"algorithm\": \""<<r.algorithm<<"\", \"dataset\": \""<<r.dataset<<"\", \"size\": "<<r.size;
+        out<<", \"runs\": "<<r.runs<<", \"median_s\": "<<r.median<<", \"p90_s\": "<<r.p90<<", \"p99_s\": "<<r.p99;
+        out<<", \"max_s\": "<<r.max;
+        out<<", \"min_s\": "<<r.min<<", \"mean_s\": "<<r.mean<<", \"hull_size\": "<<r.hull_size;
+        out<<", \"fallbacks_per_run\": "<<r.fallbacks<<"}"<<(i+1<(int)results.size() ? "," : "")<<"\n";
+    }
+    out<<"  ]\n}\n";
+}
+
+bench_config parse_arguments(int argc, char** argv){
+    bench_config config;
+    auto split=[](const string& list){
+        vector<string> items;
+        size_t start=0;
+        while (start<=list.size()){
+            size_t end=min(list.find(',', start), list.size());
+            if (end>start) items.push_back(list.substr(start, end-start));
+            start=end+1;
+        }
+        return items;
+    };
+    for (int i=1; i<argc; i++){
+        string arg=argv[i];
+        if (arg=="--prefilter"){
+            config.prefilter=true;
+            continue;
+        }
+        if (i+1>=argc) throw runtime_error("Missing value after "+arg);
+        string value=argv[++i];
+        if (arg=="--sizes") for (auto& s : split(value)) config.sizes.push_back((long long)stod(s));
+        else if (arg=="--datasets"){
+            if (value.empty() || value.find_first_not_of("ABCDEFGH")!=string::npos) throw runtime_error("Unknown dataset in "+value);
+            config.datasets=value;
+        }
+        else if (arg=="--algorithms") config.algorithms=split(value);
+        else if (arg=="--runs") config.runs=max(1, stoi(value));
+        else if (arg=="--warmup") config.warmup=max(0, stoi(value));
+        else if (arg=="--budget") config.budget=stod(value);
+        else if (arg=="--threads") config.threads=max(1, stoi(value));
+        else if (arg=="--seed") config.seed=stoul(value);
+        else if (arg=="--csv") config.csv=value;
+        else if (arg=="--json") config.json=value;
+        else throw runtime_error("Unknown option "+arg);
+    }
+    if (config.sizes.empty()) for (long long n=1000; n<=100000000; n*=10) config.sizes.push_back(n);
+    if (config.algorithms.empty()) for (auto& [name, algorithm] : ALGORITHMS) config.algorithms.push_back(name);
+    for (auto& name : config.algorithms){
+        if (none_of(all(ALGORITHMS), [&](auto& a){ return a.first==name; })) throw runtime_error("Unknown algorithm "+name);
+    }
+    return config;
+}
+
+int main(int argc, char** argv){
+    bench_config config;
+    try {
+        config=parse_arguments(argc, argv);
+    }
+    catch (const exception& e){
+        cerr<<e.what()<<"\n";
+        return 1;
+    }
+    rng.seed(config.seed);
+    write_datasets=false;
+
+    // A size is skipped if its points, the copy given to the algorithm and the work buffers do not fit in memory
+    const double memory=(double)sysconf(_SC_PHYS_PAGES)*sysconf(_SC_PAGESIZE);
+
+    cout<<"Wall-clock times in seconds, "<<config.threads<<" threads for the parallel algorithms";
+    cout<<(config.prefilter ? ", with the Akl-Toussaint prefilter" : "")<<"\n";
+    cout<<setw(15)<<left<<"algorithm"<<right<<setw(8)<<"dataset"<<setw(11)<<"size"<<setw(6)<<"runs";
+    cout<<setw(13)<<"median"<<setw(13)<<"p90"<<setw(13)<<"p99"<<setw(13)<<"max"<<setw(10)<<"hull"<<setw(11)<<"fallbacks"<<"\n";
+    vector<bench_result> results;
+    for (long long n : config.sizes){
+        if (4.*n*sizeof(point)>memory){
+            cout<<"Size "<<n<<" skipped : about "<<(long long)(4.*n*sizeof(point)/(1<<20))<<" MiB of memory needed\n";
+            continue;
+        }
+        for (char dataset : config.datasets){
+            vector<point> data{ gen_dataset(dataset, (int)max(n, 4LL)) };
+            for (auto& [name, algorithm] : ALGORITHMS){
+                if (find(all(config.algorithms), name)==config.algorithms.end()) continue;
+                bench_result r=run(name, algorithm, dataset, data, config);
+                cout<<setw(15)<<left<<r.algorithm<<right<<setw(8)<<r.dataset<<setw(11)<<r.size<<setw(6)<<r.runs;
+                cout<<scientific<<setprecision(4)<<setw(13)<<r.median<<setw(13)<<r.p90<<setw(13)<<r.p99<<setw(13)<<r.max<<defaultfloat;
+                cout<<setw(10)<<r.hull_size<<setw(11)<<r.fallbacks<<endl;
+                #ifdef HULL_STATS
+                    hull_stats per_run=r.stats;
+                    for (double* t : {&per_run.sort, &per_run.chains, &per_run.median, &per_run.bridge, &per_run.partition, &per_run.prefilter}) *t/=r.runs;
+                    for (long long* c : {&per_run.orient_tests, &per_run.pops, &per_run.bytes_allocated, &per_run.pruned}) *c/=r.runs;
+                    cout<<"    per run : ";
+                    print_stats(cout, per_run);
+                #endif
+                results.push_back(r);
+            }
+        }
+    }
+    if (!config.csv.empty()) write_csv(config.csv, results);
+    if (!config.json.empty()) write_json(config.json, results, config);
+}
@@ -2,437 +2,4649 @@
 
 
 
+/* Part 1 : Point files */
+
+// Datasets and results are stored as binary point files (see point_file_header).
+
+const char POINT_FILE_MAGIC[8]={'C','H','U','L','L','P','T','S'};
+
+// A file opened for reading, closed when the guard goes out of scope, so that the readers can throw
+struct fd_guard{
+    int fd;
+
+    explicit fd_guard(const char* filename): fd{ open(filename, O_RDONLY) } {
+        if (fd<0) throw runtime_error(string("Cannot open ")+filename);
+    }
+
+    fd_guard(const fd_guard&)=delete;
+    fd_guard& operator=(const fd_guard&)=delete;
+
+    ~fd_guard(){
+        close(fd);
+    }
+};
+
+// A mapping (or MAP_FAILED), unmapped when the guard goes out of scope
+struct map_guard{
+    void* mapped;
+    size_t bytes;
+
+    map_guard(void* mapped, size_t bytes): mapped{ mapped }, bytes{ bytes } {}
+
+    map_guard(const map_guard&)=delete;
+    map_guard& operator=(const map_guard&)=delete;
+
+    ~map_guard(){
+        if (mapped!=MAP_FAILED) munmap(mapped, bytes);
+    }
+};
+
+void read_fully(int fd, void* dst, size_t bytes, off_t offset, const char* filename){
+    char* cur=(char*)dst;
+    while (bytes>0){
+        ssize_t got=pread(fd, cur, bytes, offset);
+        if (got<=0) throw runtime_error(string("Cannot read ")+filename);
+        cur+=got;
+        bytes-=got;
+        offset+=got;
+    }
+}
+
+bool read_header(int fd, point_file_header& header){
+    return pread(fd, &header, sizeof(header), 0)==(ssize_t)sizeof(header) && memcmp(header.magic, POINT_FILE_MAGIC, 8)==0;
+}
+
+template <typename T>
+point_file_header read_header(int fd, const char* filename){
+    // Checks that the file holds points of scalar T and that it is not truncated
+    point_file_header header;
+    struct stat info;
+    if (!read_header(fd, header)) throw runtime_error(string(filename)+" is not a binary point file");
+    if (header.scalar!=scalar_code<T>() || header.point_size!=sizeof(basic_point<T>))
+        throw runtime_error(string(filename)+" does not hold points of the requested scalar type");
+    if (fstat(fd, &info)<0 || (uint64_t)info.st_size<sizeof(header)+header.count*sizeof(basic_point<T>))
+        throw runtime_error(string(filename)+" is truncated");
+    return header;
+}
+
+// The bounding box of the header is rounded outward, so that it contains every point
+template <typename T>
+double round_down(T v){
+    double d=(double)v;
+    return (ld)d>(ld)v ? nextafter(d, -numeric_limits<double>::infinity()) : d;
+}
+
+template <typename T>
+double round_up(T v){
+    double d=(double)v;
+    return (ld)d<(ld)v ? nextafter(d, numeric_limits<double>::infinity()) : d;
+}
+
+template <typename T>
+void write_points(const char* filename, const vector<basic_point<T>>& points, bool append=false){
+    // With 'append', the points are added at the end of an existing file and its header is updated
+    point_file_header header{};
+    FILE* file=append ? fopen(filename, "r+b") : nullptr;
+    if (file){
+        if (fread(&header, sizeof(header), 1, file)!=1 || memcmp(header.magic, POINT_FILE_MAGIC, 8)!=0
+            || header.scalar!=scalar_code<T>() || header.point_size!=sizeof(basic_point<T>)){
+            fclose(file);
+            throw runtime_error(string("Cannot append to ")+filename);
+        }
+    }
+    else {
+        file=fopen(filename, "wb");
+        if (!file) throw runtime_error(string("Cannot open ")+filename);
+        memcpy(header.magic, POINT_FILE_MAGIC, 8);
+        header.scalar=scalar_code<T>();
+        header.point_size=sizeof(basic_point<T>);
+        header.min_x=header.min_y=numeric_limits<double>::infinity();
+        header.max_x=header.max_y=-numeric_limits<double>::infinity();
+    }
+    for (const auto& p : points){
+        header.min_x=min(header.min_x, round_down(p.x));
+        header.min_y=min(header.min_y, round_down(p.y));
+        header.max_x=max(header.max_x, round_up(p.x));
+        header.max_y=max(header.max_y, round_up(p.y));
+    }
+    bool ok=fseek(file, sizeof(header)+header.count*sizeof(basic_point<T>), SEEK_SET)==0;
+    ok=ok && fwrite(points.data(), sizeof(basic_point<T>), points.size(), file)==points.size();
+    header.count+=points.size();
+    ok=ok && fseek(file, 0, SEEK_SET)==0 && fwrite(&header, sizeof(header), 1, file)==1;
+    ok=(fclose(file)==0) && ok;
+    if (!ok) throw runtime_error(string("Cannot write ")+filename);
+}
+
+template <typename T>
+vector<basic_point<T>> load_points(const char* filename){
+    fd_guard file(filename);
+    point_file_header header=read_header<T>(file.fd, filename);
+    vector<basic_point<T>> points(header.count);
+    read_fully(file.fd, points.data(), header.count*sizeof(basic_point<T>), sizeof(header), filename);
+    return points;
+}
+
+// The points of a binary file, mapped in memory. The mapping is private : the algorithms can sort
+// the points in place without a copy, and without modifying the file.
+template <typename T>
+class mapped_points{
+private:
+    point_file_header header_;
+    void* mapped=MAP_FAILED;
+    size_t bytes=0;
+
+public:
+    explicit mapped_points(const char* filename){
+        fd_guard file(filename);
+        header_=read_header<T>(file.fd, filename);
+        bytes=sizeof(header_)+header_.count*sizeof(basic_point<T>);
+        mapped=mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, file.fd, 0);
+        if (mapped==MAP_FAILED) throw runtime_error(string("Cannot map ")+filename);
+    }
+
+    mapped_points(const mapped_points&)=delete;
+    mapped_points& operator=(const mapped_points&)=delete;
+
+    ~mapped_points(){
+        munmap(mapped, bytes);
+    }
+
+    const point_file_header& header() const {
+        return header_;
+    }
+
+    size_t size() const {
+        return header_.count;
+    }
+
+    basic_point<T>* begin() {
+        return (basic_point<T>*)((char*)mapped+sizeof(header_));
+    }
+
+    basic_point<T>* end() {
+        return begin()+size();
+    }
+};
+
+template <typename I>
+vector<basic_point<I>> load_points_quantized(const char* filename, int bits, quantization* used_grid=nullptr){
+    // Loads a binary file of floating-point points as fixed-point ones, on a grid of 2^bits cells fitted
+    // to the bounding box of its header. The file is mapped, so that only the integer points are kept in
+    // memory. A file which already holds points of type I is loaded as it is.
+    point_file_header header;
+    if (!read_header(fd_guard(filename).fd, header)) throw runtime_error(string(filename)+" is not a binary point file");
+    if (header.scalar==scalar_code<I>()){
+        if (used_grid) *used_grid=quantization();
+        return load_points<I>(filename);
+    }
+    vector<basic_point<I>> points;
+    if (header.count==0) return points;
+    quantization grid=make_grid<I>(header.min_x, header.min_y, header.max_x, header.max_y, bits);
+    if (used_grid) *used_grid=grid;
+    auto quantize=[&](auto zero){
+        using T = decltype(zero);
+        mapped_points<T> mapped(filename);
+        points.resize(mapped.size());
+        quantize_points(mapped.begin(), mapped.end(), points.data(), grid);
+    };
+    switch (header.scalar)
+    {
+    case SCALAR_FLOAT:
+        quantize(0.f);
+        break;
+    case SCALAR_DOUBLE:
+        quantize(0.);
+        break;
+    case SCALAR_LONG_DOUBLE:
+        quantize((ld)0);
+        break;
+    default:
+        throw runtime_error(string(filename)+" holds integer points of another type");
+    }
+    return points;
+}
+
+// Text point files, one "x y" line per point, are kept for the other tools (visualizer.py, ...). They
+// are read and written with from_chars / to_chars over large blocks, by several threads. A coordinate
+// is written with 'precision' digits after the point, or, if 'precision' is negative, with the
+// shortest digits that read back to the exact same value.
+
+// Points formatted by each thread before a write
+const size_t TEXT_BLOCK=1<<16;
+// Below this number of bytes per thread, the text is parsed by a single thread
+const size_t TEXT_GRAIN=1<<20;
+
+// Powers of ten that are exact long doubles (5^27 < 2^64)
+const array<ld,28> EXACT_POWERS_OF_TEN=[](){
+    array<ld,28> powers;
+    powers[0]=1;
+    for (int i=1; i<28; i++) powers[i]=powers[i-1]*10;
+    return powers;
+}();
+
+template <typename T>
+char* format_scalar(char* out, char* end, T v, int precision){
+    // to_chars on long double goes through printf. For a small enough value, v*10^precision is computed
+    // exactly as the sum hi + lo of two long doubles and rounded to the nearest integer, ties to even,
+    // which gives the same digits as to_chars.
+    if constexpr (is_same_v<T,ld> && numeric_limits<ld>::digits>=64){
+        if (precision>=0 && precision<=18 && fabsl(v)*EXACT_POWERS_OF_TEN[precision]<0x1p62L){
+            // Dekker's product : fmal is emulated in software on x87
+            auto split=[](ld a, ld& a_hi, ld& a_lo){
+                ld c=(0x1p32L+1)*a;
+                a_hi=c-(c-a);
+                a_lo=a-a_hi;
+            };
+            ld a=fabsl(v), b=EXACT_POWERS_OF_TEN[precision], a_hi, a_lo, b_hi, b_lo;
+            split(a, a_hi, a_lo);
+            split(b, b_hi, b_lo);
+            ld hi=a*b;
+            ld lo=((a_hi*b_hi-hi)+a_hi*b_lo+a_lo*b_hi)+a_lo*b_lo;
+            ld n=nearbyintl(hi), r=hi-n;
+            if (r==0.5L && lo>0) n+=1;
+            else if (r==-0.5L && lo<0) n-=1;
+            uint64_t m=(uint64_t)n;
+            char digits[24];
+            int len=0;
+            while (m>=100){
+                // Two digits per division
+                int q=m%100;
+                m/=100;
+                digits[len++]='0'+q%10;
+                digits[len++]='0'+q/10;
+            }
+            do {
+                digits[len++]='0'+m%10;
+                m/=10;
+            } while (m>0 || len<=precision);
+            if (signbit(v)) *out++='-';
+            for (int i=len-1; i>=precision; i--) *out++=digits[i];
+            if (precision>0) *out++='.';
+            for (int i=precision-1; i>=0; i--) *out++=digits[i];
+            return out;
+        }
+    }
+    return (precision<0 ? to_chars(out, end, v) : to_chars(out, end, v, chars_format::fixed, precision)).ptr;
+}
+
+template <typename T>
+void format_points_text(const basic_point<T>* first, const basic_point<T>* last, vector<char>& buffer, size_t& used, int precision){
+    // Largest number of chars of a point : every digit of the largest finite value, plus the precision
+    const size_t bound=2*(numeric_limits<T>::max_exponent10+max(precision, 0)+numeric_limits<T>::max_digits10+8);
+    used=0;
+    for (; first!=last; first++){
+        if (buffer.size()-used<bound) buffer.resize(max(2*buffer.size(), used+bound));
+        char* out=buffer.data()+used;
+        char* end=buffer.data()+buffer.size();
+        for (T v : {first->x, first->y}){
+            out=format_scalar(out, end, v, precision);
+            *out++=' ';
+        }
+        out[-1]='\n';
+        used=out-buffer.data();
+    }
+}
+
+template <typename T>
+void write_points_text(const char* filename, const vector<basic_point<T>>& points, int precision=PRECISION, int nb_threads=thread::hardware_concurrency()){
+    FILE* file=fopen(filename, "wb");
+    if (!file) throw runtime_error(string("Cannot open ")+filename);
+    nb_threads=max(1, nb_threads);
+    vector<vector<char>> buffers(nb_threads);
+    vector<size_t> used(nb_threads);
+    const basic_point<T>* data=points.data();
+    bool ok=true;
+    for (size_t first=0; first<points.size() && ok; first+=TEXT_BLOCK*nb_threads){
+        // Each thread formats TEXT_BLOCK points, then the blocks are written in order
+        auto format=[&, first](int t){
+            size_t lo=min(points.size(), first+t*TEXT_BLOCK), hi=min(points.size(), lo+TEXT_BLOCK);
+            format_points_text(data+lo, data+hi, buffers[t], used[t], precision);
+        };
+        vector<thread> workers;
+        for (int t=1; t<nb_threads; t++) workers.emplace_back(format, t);
+        format(0);
+        for (auto& w : workers) w.join();
+        forn(t,nb_threads) ok=ok && fwrite(buffers[t].data(), 1, used[t], file)==used[t];
+    }
+    ok=(fclose(file)==0) && ok;
+    if (!ok) throw runtime_error(string("Cannot write ")+filename);
+}
+
+template <typename T>
+from_chars_result parse_scalar(const char* first, const char* last, T& v){
+    // from_chars on long double goes through strtold. Coordinates usually have at most 19 significant
+    // digits and no exponent : the mantissa and the power of ten are then exact long doubles and one
+    // division gives the correctly rounded value, the same as from_chars.
+    if constexpr (is_same_v<T,ld> && numeric_limits<ld>::digits>=64){
+        const char* cur=first;
+        bool negative=(cur<last && *cur=='-');
+        cur+=negative;
+        uint64_t mantissa=0;
+        int digits=0, decimals=0;
+        bool any=false;
+        auto read_digits=[&](bool fraction){
+            for (; cur<last && *cur>='0' && *cur<='9' && digits<=19; cur++){
+                any=true;
+                if (mantissa || *cur!='0') digits++;
+                if (digits<=19) mantissa=mantissa*10+(*cur-'0');
+                decimals+=fraction;
+            }
+        };
+        read_digits(false);
+        if (cur<last && *cur=='.'){
+            cur++;
+            read_digits(true);
+        }
+        bool exponent=(cur<last && (*cur=='e' || *cur=='E' || (*cur>='0' && *cur<='9')));
+        if (any && digits<=19 && decimals<28 && !exponent){
+            v=(ld)mantissa/EXACT_POWERS_OF_TEN[decimals];
+            if (negative) v=-v;
+            return {cur, errc()};
+        }
+    }
+    return from_chars(first, last, v);
+}
+
+template <typename T>
+void parse_points_text(const char* cur, const char* end, vector<basic_point<T>>& points, const char* filename){
+    auto skip=[&](){
+        while (cur<end && (*cur==' ' || *cur=='\n' || *cur=='\t' || *cur=='\r')) cur++;
+    };
+    auto number=[&](T& v){
+        from_chars_result res=parse_scalar(cur, end, v);
+        if (res.ec!=errc()) throw runtime_error(string("Cannot parse ")+filename);
+        cur=res.ptr;
+    };
+    T x,y;
+    skip();
+    while (cur<end){
+        number(x);
+        skip();
+        number(y);
+        skip();
+        points.push_back({x,y});
+    }
+}
+
+template <typename T>
+vector<basic_point<T>> load_points_text(const char* filename, int nb_threads=thread::hardware_concurrency()){
+    struct stat info;
+    map_guard mapping(MAP_FAILED, 0);
+    {
+        fd_guard file(filename);
+        if (fstat(file.fd, &info)<0) throw runtime_error(string("Cannot stat ")+filename);
+        if (info.st_size==0) return {};
+        mapping.bytes=info.st_size;
+        mapping.mapped=mmap(nullptr, mapping.bytes, PROT_READ, MAP_PRIVATE, file.fd, 0);
+    }
+    if (mapping.mapped==MAP_FAILED) throw runtime_error(string("Cannot map ")+filename);
+    size_t size=mapping.bytes;
+    const char* text=(const char*)mapping.mapped;
+    madvise(mapping.mapped, size, MADV_SEQUENTIAL);
+
+    // Every thread parses one chunk of the file. The bounds of the chunks are moved to the start of a line.
+    nb_threads=max(1, min(nb_threads, (int)(size/TEXT_GRAIN)));
+    vector<size_t> bounds(nb_threads+1);
+    bounds[nb_threads]=size;
+    for (int t=1; t<nb_threads; t++){
+        size_t b=max(bounds[t-1], size*t/nb_threads);
+        while (b<size && text[b-1]!='\n') b++;
+        bounds[t]=b;
+    }
+    vector<vector<basic_point<T>>> parts(nb_threads);
+    vector<exception_ptr> errors(nb_threads);
+    auto parse=[&](int t){
+        try {
+            parse_points_text(text+bounds[t], text+bounds[t+1], parts[t], filename);
+        }
+        catch (...){
+            errors[t]=current_exception();
+        }
+    };
+    vector<thread> workers;
+    for (int t=1; t<nb_threads; t++) workers.emplace_back(parse, t);
+    parse(0);
+    for (auto& w : workers) w.join();
+    for (auto& e : errors) if (e) rethrow_exception(e);
+
+    if (nb_threads==1) return move(parts[0]);
+    size_t n=0;
+    for (auto& part : parts) n+=part.size();
+    vector<basic_point<T>> points;
+    points.reserve(n);
+    for (auto& part : parts) points.insert(points.end(), all(part));
+    return points;
+}
+
+void convert_point_file(const char* input, const char* output, scalar_type scalar=SCALAR_LONG_DOUBLE, int precision=PRECISION){
+    // Binary to text if the input is a binary point file, otherwise text to binary points of 'scalar'
+    point_file_header header;
+    bool binary=read_header(fd_guard(input).fd, header);
+    auto convert=[&](auto zero){
+        using T = decltype(zero);
+        if (binary) write_points_text(output, load_points<T>(input), precision);
+        else write_points(output, load_points_text<T>(input));
+    };
+    switch (binary ? (scalar_type)header.scalar : scalar)
+    {
+    case SCALAR_FLOAT:
+        convert(0.f);
+        break;
+    case SCALAR_DOUBLE:
+        convert(0.);
+        break;
+    default:
+        convert((ld)0);
+        break;
+    }
+}
+
 /* Part 2 : datasets*/
 
-// Functions to generate point datasets. After generation, points can be found in the "datasetX.txt" files
+// Functions to generate point datasets. After generation, points can be found in the "datasetX.bin" files.
+// Every generator takes an explicit seed (by default the next value of rng, so that rng.seed() makes a
+// whole run reproducible) and fills its points in parallel. The random values of point i only depend
+// on the seed and on i, so the dataset is the same whatever the number of threads.
+
+bool write_datasets=true; // The benchmark turns it off, it does not need the files
+
+const int GENERATOR_GRAIN=1<<14; // Points per thread at least
+const int DRAWS_PER_POINT=8;     // Random values a generator can use for one point
+
+// Counter-based random generator : the k-th value of point i is the SplitMix64 mix of the seed and of
+// the counter i*DRAWS_PER_POINT+k, so that any value can be drawn directly, by any thread.
+struct counter_rng{
+    uint64_t key;
+
+    static uint64_t mix(uint64_t z){
+        z=(z^(z>>30))*0xBF58476D1CE4E5B9ULL;
+        z=(z^(z>>27))*0x94D049BB133111EBULL;
+        return z^(z>>31);
+    }
+
+    counter_rng(uint64_t seed): key{ mix(seed) } {}
+
+    uint64_t bits(uint64_t i, int k) const {
+        return mix(key+(i*DRAWS_PER_POINT+k+1)*0x9E3779B97F4A7C15ULL);
+    }
+
+    // Uniform in [0,1), with 53 random bits so that the coordinates are exact doubles
+    ld uniform(uint64_t i, int k) const {
+        return (ld)(bits(i, k)>>11)*0x1p-53L;
+    }
+
+    // Uniform in [0,n)
+    uint64_t below(uint64_t i, int k, uint64_t n) const {
+        return (uint64_t)(((unsigned __int128)bits(i, k)*n)>>64);
+    }
+
+    // Two independent standard normals (Box-Muller) from the values k and k+1. Computed in double,
+    // as the trigonometry on long double is several times slower.
+    pair<double,double> gaussians(uint64_t i, int k) const {
+        double r=sqrt(-2*log(1-(double)uniform(i, k))); // 1-uniform is in (0,1]
+        double theta=2*M_PI*(double)uniform(i, k+1);
+        return {r*cos(theta), r*sin(theta)};
+    }
+};
+
+// Index of the values that set the parameters of a dataset (rotation, clusters...), out of the range
+// of the points
+const uint64_t PARAMETERS=UINT64_MAX/DRAWS_PER_POINT-1;
+
+template <typename F>
+vector<point> generate_points(int n, int nb_threads, F&& make){
+    // points[i]=make(i), computed by blocks of consecutive points on nb_threads threads
+    vector<point> points(n);
+    nb_threads=max(1, min(nb_threads, n/GENERATOR_GRAIN));
+    vector<thread> workers;
+    auto fill=[&](int t){
+        int first=(long long)n*t/nb_threads, last=(long long)n*(t+1)/nb_threads;
+        for (int i=first; i<last; i++) points[i]=make(i);
+    };
+    for (int t=1; t<nb_threads; t++) workers.emplace_back(fill, t);
+    fill(0);
+    for (auto& w : workers) w.join();
+    return points;
+}
+
+vector<point> genA(int n, uint64_t seed=rng(), int nb_threads=thread::hardware_concurrency()){
+    // Generates n-4 points randomly in the [0,1]^2 square, and adds the corners at random places. Applies a random rotation
+    // The resulting points can be outside of [0,1]^2 but it doesn't matter. The center of rotation is chosen randomly in [0,1]^2
+    // If n<4, this function returns an error 
+    assert(n>=4 && "There are less than 4 points given to genA !");
+
+    counter_rng gen(seed);
+    point rotation_center={gen.uniform(PARAMETERS, 0), gen.uniform(PARAMETERS, 1)};
+    ld rotation_angle=gen.uniform(PARAMETERS, 2)*2.*M_PI;
+    ld c=cos(rotation_angle);
+    ld s=sin(rotation_angle);
+
+    // Define a lambda-function for the rotation (even though there is probably one somewhere in the stl)
+    auto rotate = [&](point pt){
+        point centerToPt={pt.x-rotation_center.x, pt.y-rotation_center.y}; // Take the vector from center to target point
+        point rotated={centerToPt.x*c-centerToPt.y*s, centerToPt.x*s+centerToPt.y*c}; //Apply the well-known rotation matrix Rtheta
+        rotated.x+=rotation_center.x; rotated.y+=rotation_center.y;
+        return rotated;
+    };
+    vector<point> points{ generate_points(n-4, nb_threads, [&](int i){
+        return rotate({gen.uniform(i, 0), gen.uniform(i, 1)});
+    }) };
+    // Each corner goes to a random place and the point there is moved to the end : as the other points
+    // are independent, this is as good as a shuffle
+    point corners[4]={{0.,0.}, {1.,0.}, {0.,1.}, {1.,1.}};
+    forn(k,4){
+        points.push_back(rotate(corners[k]));
+        swap(points.back(), points[gen.below(PARAMETERS, 3+k, points.size())]);
+    }
+
+    if (write_datasets) write_points("datasetA.bin", points);
+    return points;
+}
+
+vector<point> genB(int n, uint64_t seed=rng(), int nb_threads=thread::hardware_concurrency()){
+    counter_rng gen(seed);
+    vector<point> points{ generate_points(n, nb_threads, [&](int i){
+        return point(gen.uniform(i, 0), gen.uniform(i, 1));
+    }) };
+    if (write_datasets) write_points("datasetB.bin", points);
+    return points;
+}
+
+vector<point> genC(int n, uint64_t seed=rng(), int nb_threads=thread::hardware_concurrency()){
+    // Uniform in the disk of center (0.5,0.5) and radius 0.5, by inversion of the distribution of the
+    // radius rather than by rejection, so that each point takes a fixed number of random values
+    counter_rng gen(seed);
+    vector<point> points{ generate_points(n, nb_threads, [&](int i){
+        double r=0.5*sqrt((double)gen.uniform(i, 0));
+        double theta=2.*M_PI*(double)gen.uniform(i, 1);
+        return point(0.5+r*cos(theta), 0.5+r*sin(theta));
+    }) };
+    if (write_datasets) write_points("datasetC.bin", points);
+    return points;
+}
+
+vector<point> genD(int n, uint64_t seed=rng(), int nb_threads=thread::hardware_concurrency()){
+    counter_rng gen(seed);
+    vector<point> points{ generate_points(n, nb_threads, [&](int i){
+        double theta=2.*M_PI*(double)gen.uniform(i, 0);
+        return point(0.5*cos(theta)+0.5, 0.5*sin(theta)+0.5);
+    }) };
+    if (write_datasets) write_points("datasetD.bin", points);
+    return points;
+}
+
+// Stress datasets
+
+vector<point> genE(int n, uint64_t seed=rng(), int nb_threads=thread::hardware_concurrency()){
+    // Gaussian clusters : NB_CLUSTERS clusters with random centers in [0.2,0.8]^2 and random deviations
+    const int NB_CLUSTERS=8;
+    counter_rng gen(seed);
+    point centers[NB_CLUSTERS];
+    ld deviations[NB_CLUSTERS];
+    forn(j,NB_CLUSTERS){
+        centers[j]={0.2+0.6*gen.uniform(PARAMETERS-j, 0), 0.2+0.6*gen.uniform(PARAMETERS-j, 1)};
+        deviations[j]=0.01+0.05*gen.uniform(PARAMETERS-j, 2);
+    }
+    vector<point> points{ generate_points(n, nb_threads, [&](int i){
+        int j=gen.below(i, 0, NB_CLUSTERS);
+        auto [gx, gy]=gen.gaussians(i, 1);
+        return point(centers[j].x+deviations[j]*gx, centers[j].y+deviations[j]*gy);
+    }) };
+    if (write_datasets) write_points("datasetE.bin", points);
+    return points;
+}
+
+vector<point> genF(int n, uint64_t seed=rng(), int nb_threads=thread::hardware_concurrency()){
+    // Points on a few lines. On the horizontal, vertical and diagonal ones the coordinates are multiples
+    // of 2^-32, so the points are exactly collinear ; on the last one they are rounded, so almost collinear.
+    counter_rng gen(seed);
+    auto grid=[&](uint64_t i, int k){ return (ld)(gen.bits(i, k)>>32)*0x1p-32L; };
+    ld c[3]={grid(PARAMETERS, 0), grid(PARAMETERS, 1), grid(PARAMETERS, 2)/2};
+    point a(gen.uniform(PARAMETERS, 3), gen.uniform(PARAMETERS, 4)), b(gen.uniform(PARAMETERS, 5), gen.uniform(PARAMETERS, 6));
+    vector<point> points{ generate_points(n, nb_threads, [&](int i){
+        ld t=grid(i, 1);
+        switch (gen.below(i, 0, 4))
+        {
+        case 0:
+            return point(t, c[0]);
+        case 1:
+            return point(c[1], t);
+        case 2:
+            return point(t/2, t/2+c[2]);
+        default:
+            return point(a.x+t*(b.x-a.x), a.y+t*(b.y-a.y));
+        }
+    }) };
+    if (write_datasets) write_points("datasetF.bin", points);
+    return points;
+}
+
+vector<point> genG(int n, uint64_t seed=rng(), int nb_threads=thread::hardware_concurrency()){
+    // Heavy duplicates : the points are drawn among n/1000 distinct points (at least 4). The distinct
+    // points come from a second generator, so they are not stored.
+    counter_rng gen(seed), pool(~seed);
+    uint64_t nb_distinct=max(4, n/1000);
+    vector<point> points{ generate_points(n, nb_threads, [&](int i){
+        uint64_t j=gen.below(i, 0, nb_distinct);
+        return point(pool.uniform(j, 0), pool.uniform(j, 1));
+    }) };
+    if (write_datasets) write_points("datasetG.bin", points);
+    return points;
+}
+
+vector<point> genH(int n, uint64_t seed=rng(), int nb_threads=thread::hardware_concurrency()){
+    // Adversarial input for the median and the bridges of Algorithm2, mixing :
+    //  - points on the vertical line x=0.5, that is at the median abscissa
+    //  - points exactly on the top edge of the hull, from (0.25,1) to (0.75,1), which are all on the bridge
+    //  - points on the lower half of the circle of center (0.5,0.5), which are all (up to rounding) on the hull
+    //  - copies of the ends of the top edge and of the lowest and highest points
+    counter_rng gen(seed);
+    const point copies[4]={{0.25,1.}, {0.75,1.}, {0.5,0.}, {0.5,1.}};
+    vector<point> points{ generate_points(n, nb_threads, [&](int i){
+        switch (gen.below(i, 0, 4))
+        {
+        case 0:
+            return point(0.5, gen.uniform(i, 1));
+        case 1:
+            return point(0.25+(ld)(gen.bits(i, 1)>>33)*0x1p-32L, 1.);
+        case 2:
+        {
+            double theta=M_PI*(1+(double)gen.uniform(i, 1));
+            return point(0.5+0.5*cos(theta), 0.5+0.5*sin(theta));
+        }
+        default:
+            return copies[gen.below(i, 1, 4)];
+        }
+    }) };
+    if (write_datasets) write_points("datasetH.bin", points);
+    return points;
+}
+
+const int NB_DATASETS=8;
+
+vector<point> gen_dataset(char dataset, int n, uint64_t seed=rng(), int nb_threads=thread::hardware_concurrency()){
+    switch (dataset)
+    {
+    case 'A':
+        return genA(n, seed, nb_threads);
+    case 'B':
+        return genB(n, seed, nb_threads);
+    case 'C':
+        return genC(n, seed, nb_threads);
+    case 'D':
+        return genD(n, seed, nb_threads);
+    case 'E':
+        return genE(n, seed, nb_threads);
+    case 'F':
+        return genF(n, seed, nb_threads);
+    case 'G':
+        return genG(n, seed, nb_threads);
+    default:
+        return genH(n, seed, nb_threads);
+    }
+}
+
+/* Part 2 bis : Robust orientation predicate */
+
+// The sign of cross(b-a, c-a) is first evaluated in double with an error bound. Only when the result
+// is too close to 0 for its sign to be certain, it is recomputed exactly with floating-point
+// expansions (sums of non-overlapping terms, as in Shewchuk's predicates).
+// Assumes no overflow nor underflow, which holds for coordinates of reasonable magnitude.
+
+// Fixed-point coordinates (int32_t, int64_t) take another path : cross products are computed exactly
+// with 128 bits integers, which fit as long as the coordinates stay below 2^62 in absolute value.
+
+atomic<long long> orient_fallbacks{0}; // Number of exact evaluations of the predicates, for the perf driver
+
+// Floating-point type which holds the coordinates exactly : long double for the 64 bits integers
+template <typename T>
+using wide_scalar=conditional_t<is_integral_v<T>, conditional_t<(sizeof(T)<=4), double, ld>, common_type_t<T, double>>;
+
+template <typename T>
+__int128 cross_integer(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>& c){
+    // cross(b-a, c-a), exactly : the differences fit in 63 bits and the products in 126 bits
+    return (__int128)((int64_t)b.x-a.x)*((int64_t)c.y-a.y)-(__int128)((int64_t)b.y-a.y)*((int64_t)c.x-a.x);
+}
+
+template <typename T>
+int orient_integer(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>& c){
+    __int128 det=cross_integer(a, b, c);
+    return (det>0)-(det<0);
+}
+
+template <typename T>
+void two_sum(T a, T b, T& x, T& y){
+    // x + y == a + b exactly, with x the rounded sum
+    x=a+b;
+    T b_virtual=x-a;
+    T a_virtual=x-b_virtual;
+    y=(a-a_virtual)+(b-b_virtual);
+}
+
+template <typename T>
+void two_product(T a, T b, T& x, T& y){
+    // x + y == a * b exactly, with x the rounded product
+    x=a*b;
+    y=fma(a, b, -x);
+}
+
+template <typename T>
+int orient_filtered(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>& c){
+    // Sign of cross(b-a, c-a) evaluated in double : 1 if counter-clockwise, -1 if clockwise, and 0
+    // if the rounding errors could change the sign (including when the result is 0).
+    // The differences are taken in the wider of T and double : each one is rounded once in that type
+    // and at most once more when converted to double. Integer coordinates are exact.
+    if constexpr (is_integral_v<T>) return orient_integer(a, b, c);
+    using wide=wide_scalar<T>;
+    double abx=(wide)b.x-(wide)a.x, aby=(wide)b.y-(wide)a.y;
+    double acx=(wide)c.x-(wide)a.x, acy=(wide)c.y-(wide)a.y;
+    double left=abx*acy, right=aby*acx;
+    double det=left-right;
+    // Each difference has a relative error of about u = 2^-53, each product 3u and the subtraction
+    // adds u : 5u is an upper bound with margin.
+    const double errbound=5*(numeric_limits<double>::epsilon()/2)*(fabs(left)+fabs(right));
+    if (det>errbound) return 1;
+    if (-det>errbound) return -1;
+    return 0;
+}
+
+template <typename T>
+int orient_exact(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>& c){
+    // Sign of cross(b-a, c-a) = a.x*b.y - a.x*c.y - a.y*b.x + a.y*c.x + b.x*c.y - b.y*c.x, each
+    // product being split in two terms and added to an expansion.
+    using wide=wide_scalar<T>;
+    const wide terms[6][2]={{a.x, b.y}, {-a.x, c.y}, {-a.y, b.x}, {a.y, c.x}, {b.x, c.y}, {-b.y, c.x}};
+    array<wide,12> expansion;
+    int size=0;
+    for (const auto& term : terms){
+        wide products[2];
+        two_product(term[0], term[1], products[0], products[1]);
+        for (wide q : products){
+            // Grow the expansion by q : its terms stay non-overlapping and sorted by magnitude
+            forn(i,size) two_sum(q, expansion[i], q, expansion[i]);
+            expansion[size++]=q;
+        }
+    }
+    // The sign of an expansion is the sign of its largest non-zero term
+    for (int i=size-1; i>=0; i--){
+        if (expansion[i]>0) return 1;
+        if (expansion[i]<0) return -1;
+    }
+    return 0;
+}
+
+template <typename T>
+int orient_sign(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>& c){
+    // Exact sign of cross(b-a, c-a) : 1 if counter-clockwise, -1 if clockwise, 0 if collinear
+    STATS_ADD(orient_tests, 1);
+    if constexpr (is_integral_v<T>) return orient_integer(a, b, c);
+    else {
+        int sign=orient_filtered(a, b, c);
+        if (sign!=0) return sign;
+        // Points on a horizontal or vertical line, and copies, make one of the products exactly 0 : the
+        // sign is then the one of the other product, given by comparisons
+        if (c==b) return 0;
+        auto cmp=[](T s, T t){ return (s>t)-(s<t); };
+        if (b.x==a.x || c.y==a.y) return -cmp(b.y, a.y)*cmp(c.x, a.x);
+        if (b.y==a.y || c.x==a.x) return cmp(b.x, a.x)*cmp(c.y, a.y);
+        orient_fallbacks.fetch_add(1, memory_order_relaxed);
+        return orient_exact(a, b, c);
+    }
+}
+
+// Expansions of any length, for the rarer predicates of higher degree. Zero terms are dropped.
+
+template <typename E>
+void grow_expansion(vector<E>& e, E q){
+    // Adds q to the expansion e : its terms stay non-overlapping and sorted by magnitude
+    for (auto& t : e) two_sum(q, t, q, t);
+    e.push_back(q);
+    e.erase(remove(all(e), (E)0), e.end());
+}
+
+template <typename E>
+vector<E> expansion_diff(E a, E b){
+    // a - b, exactly
+    vector<E> res;
+    grow_expansion(res, a);
+    grow_expansion(res, -b);
+    return res;
+}
+
+template <typename E>
+vector<E> expansion_product(const vector<E>& e, const vector<E>& f){
+    vector<E> res;
+    for (E s : e) for (E t : f){
+        E x, y;
+        two_product(s, t, x, y);
+        grow_expansion(res, y);
+        grow_expansion(res, x);
+    }
+    return res;
+}
+
+template <typename E>
+vector<E> expansion_sum(vector<E> e, const vector<E>& f, E f_sign){
+    // e + f_sign * f, with f_sign = 1 or -1
+    for (E t : f) grow_expansion(e, f_sign*t);
+    return e;
+}
+
+template <typename E>
+int expansion_sign(const vector<E>& e){
+    // The sign of an expansion is the sign of its largest term
+    return e.empty() ? 0 : (e.back()>0 ? 1 : -1);
+}
+
+template <typename T>
+int intersection_cmp(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>& c, const basic_point<T>& d, const basic_point<T>& q){
+    // Compares the intersection P of the lines (a, b) and (c, d), which must not be parallel, with q
+    // in the lexicographic order : -1 if P < q, 0 if P == q and 1 if P > q.
+    // P = a + (b-a) * D2 / D1 with D1 = cross(b-a, d-c) and D2 = cross(c-a, d-c), so the sign of
+    // P.x - q.x is the sign of ((a.x-q.x)*D1 + (b.x-a.x)*D2) * D1, and the same for y.
+    if constexpr (is_integral_v<T> && sizeof(T)<=4){
+        // D1 and D2 fit in 67 bits and the numerators in 102 bits
+        auto diff=[](T s, T t){ return (__int128)((int64_t)s-t); };
+        __int128 d1=diff(b.x, a.x)*diff(d.y, c.y)-diff(b.y, a.y)*diff(d.x, c.x);
+        __int128 d2=diff(c.x, a.x)*diff(d.y, c.y)-diff(c.y, a.y)*diff(d.x, c.x);
+        __int128 f=diff(a.x, q.x)*d1+diff(b.x, a.x)*d2;
+        if (f==0) f=diff(a.y, q.y)*d1+diff(b.y, a.y)*d2;
+        return ((f>0)-(f<0))*(d1>0 ? 1 : -1);
+    }
+    using wide=wide_scalar<T>;
+    double bax=(wide)b.x-(wide)a.x, bay=(wide)b.y-(wide)a.y;
+    double cax=(wide)c.x-(wide)a.x, cay=(wide)c.y-(wide)a.y;
+    double dcx=(wide)d.x-(wide)c.x, dcy=(wide)d.y-(wide)c.y;
+    double aqx=(wide)a.x-(wide)q.x;
+    double l1=bax*dcy, r1=bay*dcx, l2=cax*dcy, r2=cay*dcx;
+    double d1=l1-r1, d2=l2-r2;
+    double fx=aqx*d1+bax*d2;
+    // Same analysis as orient_filtered for D1, one more product and sum for the numerator
+    const double u=numeric_limits<double>::epsilon()/2;
+    const double bound1=5*u*(fabs(l1)+fabs(r1));
+    const double boundx=8*u*(fabs(aqx)*(fabs(l1)+fabs(r1))+fabs(bax)*(fabs(l2)+fabs(r2)));
+    if (fabs(d1)>bound1 && fabs(fx)>boundx) return (fx>0)==(d1>0) ? 1 : -1;
+
+    orient_fallbacks.fetch_add(1, memory_order_relaxed);
+    auto diff = [](T s, T t){ return expansion_diff<wide>(s, t); };
+    auto cross_expansion = [&](const vector<wide>& ux, const vector<wide>& uy, const vector<wide>& vx, const vector<wide>& vy){
+        return expansion_sum(expansion_product(ux, vy), expansion_product(uy, vx), (wide)-1);
+    };
+    vector<wide> ex_bax=diff(b.x, a.x), ex_bay=diff(b.y, a.y), ex_dcx=diff(d.x, c.x), ex_dcy=diff(d.y, c.y);
+    vector<wide> ex_d1=cross_expansion(ex_bax, ex_bay, ex_dcx, ex_dcy);
+    vector<wide> ex_d2=cross_expansion(diff(c.x, a.x), diff(c.y, a.y), ex_dcx, ex_dcy);
+    int sign1=expansion_sign(ex_d1);
+    vector<wide> ex_fx=expansion_sum(expansion_product(diff(a.x, q.x), ex_d1), expansion_product(ex_bax, ex_d2), (wide)1);
+    if (expansion_sign(ex_fx)!=0) return expansion_sign(ex_fx)*sign1;
+    vector<wide> ex_fy=expansion_sum(expansion_product(diff(a.y, q.y), ex_d1), expansion_product(ex_bay, ex_d2), (wide)1);
+    return expansion_sign(ex_fy)*sign1;
+}
+
+/* Part 2 ter : Observers */
+
+// The hull algorithms take an observer as a template parameter and report their steps to it : a new
+// chain, a point pushed on or popped from the chain, an orientation test and its sign, a bridge found
+// by the divide and conquer. null_observer, the default, has empty inline functions, so the calls
+// vanish at compile time. trace_observer records the steps in a compact binary trace, which the
+// visualizer replays. Observers are not thread-safe : the parallel algorithms do not take one.
+
+enum trace_event_type : uint8_t { TRACE_CHAIN, TRACE_PUSH, TRACE_POP, TRACE_ORIENT, TRACE_BRIDGE };
+
+struct null_observer{
+    static constexpr bool enabled=false;
+
+    void chain() {}
+    template <typename P> void push(const P&) {}
+    template <typename P> void pop(const P&) {}
+    template <typename P> void orient(const P&, const P&, const P&, int) {}
+    template <typename P> void bridge(const P&, const P&) {}
+};
+
+// One step of a trace. Coordinates are stored as floats, which is enough to draw them.
+struct trace_event{
+    trace_event_type type;
+    int sign; // Result of TRACE_ORIENT
+    basic_point<float> points[3]={ {0,0}, {0,0}, {0,0} };
+};
+
+// Number of points of each type of event
+const int TRACE_EVENT_POINTS[5]={0, 1, 1, 3, 2};
+const char TRACE_MAGIC[8]={'C','H','U','L','L','T','R','C'};
+
+// A trace is a sequence of events of 2 bytes (type, sign) followed by the points of the event
+class trace_observer{
+private:
+    vector<uint8_t> bytes;
+
+    template <typename P>
+    void add(trace_event_type type, int sign, initializer_list<P> points){
+        bytes.push_back(type);
+        bytes.push_back((uint8_t)(int8_t)sign);
+        for (const P& p : points){
+            float xy[2]={(float)p.x, (float)p.y};
+            bytes.insert(bytes.end(), (uint8_t*)xy, (uint8_t*)xy+sizeof(xy));
+        }
+    }
+
+public:
+    static constexpr bool enabled=true;
+
+    void chain() { add<basic_point<float>>(TRACE_CHAIN, 0, {}); }
+    template <typename P> void push(const P& p) { add(TRACE_PUSH, 0, {p}); }
+    template <typename P> void pop(const P& p) { add(TRACE_POP, 0, {p}); }
+    template <typename P> void orient(const P& a, const P& b, const P& c, int sign) { add(TRACE_ORIENT, sign, {a, b, c}); }
+    template <typename P> void bridge(const P& p1, const P& p2) { add(TRACE_BRIDGE, 0, {p1, p2}); }
+
+    const vector<uint8_t>& data() const {
+        return bytes;
+    }
+
+    void save(const char* filename) const {
+        FILE* file=fopen(filename, "wb");
+        if (!file) throw runtime_error(string("Cannot open ")+filename);
+        bool ok=fwrite(TRACE_MAGIC, 1, 8, file)==8 && fwrite(bytes.data(), 1, bytes.size(), file)==bytes.size();
+        ok=(fclose(file)==0) && ok;
+        if (!ok) throw runtime_error(string("Cannot write ")+filename);
+    }
+};
+
+vector<trace_event> read_trace(const vector<uint8_t>& bytes){
+    vector<trace_event> events;
+    size_t i=0;
+    while (i+2<=bytes.size()){
+        trace_event e;
+        if (bytes[i]>TRACE_BRIDGE) throw runtime_error("Unknown trace event");
+        e.type=(trace_event_type)bytes[i];
+        e.sign=(int8_t)bytes[i+1];
+        i+=2;
+        forn(j,TRACE_EVENT_POINTS[e.type]){
+            if (i+8>bytes.size()) throw runtime_error("Truncated trace");
+            memcpy(&e.points[j].x, &bytes[i], 4);
+            memcpy(&e.points[j].y, &bytes[i+4], 4);
+            i+=8;
+        }
+        events.push_back(e);
+    }
+    return events;
+}
+
+vector<trace_event> load_trace(const char* filename){
+    ifstream in(filename, ios::binary);
+    vector<uint8_t> bytes{ istreambuf_iterator<char>(in), istreambuf_iterator<char>() };
+    if (bytes.size()<8 || memcmp(bytes.data(), TRACE_MAGIC, 8)!=0) throw runtime_error(string(filename)+" is not a trace");
+    return read_trace(vector<uint8_t>(bytes.begin()+8, bytes.end()));
+}
+
+/* Part 2 quater : Vectorized kernels */
+
+// Kernels over arrays of points : filtered orientation of many points against one segment, and search
+// of the lexicographic extremes. For double coordinates they have SSE2, AVX2 and AVX-512 versions,
+// chosen at run time by the features of the CPU ; the other scalar types (long double has no vector
+// instructions) take the scalar loops. The kernels give the same results as the scalar predicates.
+
+enum simd_level { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512 };
+const char* SIMD_NAMES[4]={"scalar", "sse2", "avx2", "avx512"};
+
+simd_level detect_simd(){
+    #ifdef __x86_64__
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return SIMD_AVX512;
+        if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+        return SIMD_SSE2;
+    #else
+        return SIMD_SCALAR;
+    #endif
+}
+
+simd_level simd_dispatch=detect_simd(); // Can be lowered, to compare the kernels
+
+// Same bound as orient_filtered : 5u with u = 2^-53
+const double ORIENT_ERRBOUND=5*(numeric_limits<double>::epsilon()/2);
+
+#ifdef __x86_64__
+static_assert(sizeof(basic_point<double>)==2*sizeof(double), "The kernels read the points as an array of doubles");
+
+// Each block of points gives two bitmasks : the points certainly counter-clockwise (pos) and certainly
+// clockwise (neg) from the segment. They become signs 1, -1 and 0 as in orient_filtered.
+inline void write_signs(int pos, int neg, int width, int8_t* signs){
+    forn(j,width) signs[j]=((pos>>j)&1)-((neg>>j)&1);
+}
+
+void orient_batch_sse2(const basic_point<double>& a, const basic_point<double>& b, const basic_point<double>* points, int n, int8_t* signs){
+    const double* p=&points[0].x;
+    const __m128d ax=_mm_set1_pd(a.x), ay=_mm_set1_pd(a.y), abx=_mm_set1_pd(b.x-a.x), aby=_mm_set1_pd(b.y-a.y);
+    const __m128d bound=_mm_set1_pd(ORIENT_ERRBOUND), sign_bit=_mm_set1_pd(-0.);
+    int i=0;
+    for (; i+2<=n; i+=2){
+        __m128d v0=_mm_loadu_pd(p+2*i), v1=_mm_loadu_pd(p+2*i+2);
+        __m128d acx=_mm_sub_pd(_mm_unpacklo_pd(v0, v1), ax), acy=_mm_sub_pd(_mm_unpackhi_pd(v0, v1), ay);
+        __m128d left=_mm_mul_pd(abx, acy), right=_mm_mul_pd(aby, acx);
+        __m128d det=_mm_sub_pd(left, right);
+        __m128d err=_mm_mul_pd(bound, _mm_add_pd(_mm_andnot_pd(sign_bit, left), _mm_andnot_pd(sign_bit, right)));
+        write_signs(_mm_movemask_pd(_mm_cmpgt_pd(det, err)), _mm_movemask_pd(_mm_cmplt_pd(det, _mm_xor_pd(err, sign_bit))), 2, signs+i);
+    }
+    for (; i<n; i++) signs[i]=orient_filtered(a, b, points[i]);
+}
+
+__attribute__((target("avx2")))
+void orient_batch_avx2(const basic_point<double>& a, const basic_point<double>& b, const basic_point<double>* points, int n, int8_t* signs){
+    const double* p=&points[0].x;
+    const __m256d ax=_mm256_set1_pd(a.x), ay=_mm256_set1_pd(a.y), abx=_mm256_set1_pd(b.x-a.x), aby=_mm256_set1_pd(b.y-a.y);
+    const __m256d bound=_mm256_set1_pd(ORIENT_ERRBOUND), sign_bit=_mm256_set1_pd(-0.);
+    int i=0;
+    for (; i+4<=n; i+=4){
+        // (x0 y0 x1 y1), (x2 y2 x3 y3) -> (x0 y0 x2 y2), (x1 y1 x3 y3) -> (x0 x1 x2 x3), (y0 y1 y2 y3)
+        __m256d v0=_mm256_loadu_pd(p+2*i), v1=_mm256_loadu_pd(p+2*i+4);
+        __m256d lo=_mm256_permute2f128_pd(v0, v1, 0x20), hi=_mm256_permute2f128_pd(v0, v1, 0x31);
+        __m256d acx=_mm256_sub_pd(_mm256_unpacklo_pd(lo, hi), ax), acy=_mm256_sub_pd(_mm256_unpackhi_pd(lo, hi), ay);
+        __m256d left=_mm256_mul_pd(abx, acy), right=_mm256_mul_pd(aby, acx);
+        __m256d det=_mm256_sub_pd(left, right);
+        __m256d err=_mm256_mul_pd(bound, _mm256_add_pd(_mm256_andnot_pd(sign_bit, left), _mm256_andnot_pd(sign_bit, right)));
+        int pos=_mm256_movemask_pd(_mm256_cmp_pd(det, err, _CMP_GT_OQ));
+        int neg=_mm256_movemask_pd(_mm256_cmp_pd(det, _mm256_xor_pd(err, sign_bit), _CMP_LT_OQ));
+        write_signs(pos, neg, 4, signs+i);
+    }
+    for (; i<n; i++) signs[i]=orient_filtered(a, b, points[i]);
+}
+
+__attribute__((target("avx512f")))
+void orient_batch_avx512(const basic_point<double>& a, const basic_point<double>& b, const basic_point<double>* points, int n, int8_t* signs){
+    const double* p=&points[0].x;
+    const __m512d ax=_mm512_set1_pd(a.x), ay=_mm512_set1_pd(a.y), abx=_mm512_set1_pd(b.x-a.x), aby=_mm512_set1_pd(b.y-a.y);
+    const __m512d bound=_mm512_set1_pd(ORIENT_ERRBOUND);
+    const __m512i even=_mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0), odd=_mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+    int i=0;
+    for (; i+8<=n; i+=8){
+        __m512d v0=_mm512_loadu_pd(p+2*i), v1=_mm512_loadu_pd(p+2*i+8);
+        __m512d acx=_mm512_sub_pd(_mm512_permutex2var_pd(v0, even, v1), ax);
+        __m512d acy=_mm512_sub_pd(_mm512_permutex2var_pd(v0, odd, v1), ay);
+        __m512d left=_mm512_mul_pd(abx, acy), right=_mm512_mul_pd(aby, acx);
+        __m512d det=_mm512_sub_pd(left, right);
+        __m512d err=_mm512_mul_pd(bound, _mm512_add_pd(_mm512_abs_pd(left), _mm512_abs_pd(right)));
+        int pos=_mm512_cmp_pd_mask(det, err, _CMP_GT_OQ);
+        int neg=_mm512_cmp_pd_mask(_mm512_sub_pd(_mm512_setzero_pd(), det), err, _CMP_GT_OQ);
+        write_signs(pos, neg, 8, signs+i);
+    }
+    for (; i<n; i++) signs[i]=orient_filtered(a, b, points[i]);
+}
+
+// Lexicographic extremes : each lane keeps the first minimum and the first maximum of its points, with
+// their indices (stored as doubles, exact below 2^53). The lanes are then reduced in scalar.
+inline void reduce_extremes(const double* min_x, const double* min_y, const double* min_i,
+                            const double* max_x, const double* max_y, const double* max_i, int width, int& arg_min, int& arg_max){
+    int lo=0, hi=0;
+    for (int j=1; j<width; j++){
+        basic_point<double> p(min_x[j], min_y[j]), q(max_x[j], max_y[j]);
+        basic_point<double> best_lo(min_x[lo], min_y[lo]), best_hi(max_x[hi], max_y[hi]);
+        if (p<best_lo || (p==best_lo && min_i[j]<min_i[lo])) lo=j;
+        if (best_hi<q || (q==best_hi && max_i[j]<max_i[hi])) hi=j;
+    }
+    arg_min=(int)min_i[lo];
+    arg_max=(int)max_i[hi];
+}
+
+pair<int,int> extreme_points_sse2(const basic_point<double>* points, int n){
+    const double* p=&points[0].x;
+    __m128d v0=_mm_loadu_pd(p), v1=_mm_loadu_pd(p+2);
+    __m128d min_x=_mm_unpacklo_pd(v0, v1), min_y=_mm_unpackhi_pd(v0, v1), min_i=_mm_set_pd(1, 0);
+    __m128d max_x=min_x, max_y=min_y, max_i=min_i;
+    __m128d index=min_i;
+    const __m128d step=_mm_set1_pd(2);
+    // Branch-free select of the SSE2 instruction set
+    auto blend=[](__m128d a, __m128d b, __m128d mask){ return _mm_or_pd(_mm_andnot_pd(mask, a), _mm_and_pd(mask, b)); };
+    int i=2;
+    for (; i+2<=n; i+=2){
+        v0=_mm_loadu_pd(p+2*i);
+        v1=_mm_loadu_pd(p+2*i+2);
+        __m128d x=_mm_unpacklo_pd(v0, v1), y=_mm_unpackhi_pd(v0, v1);
+        index=_mm_add_pd(index, step);
+        __m128d lt=_mm_or_pd(_mm_cmplt_pd(x, min_x), _mm_and_pd(_mm_cmpeq_pd(x, min_x), _mm_cmplt_pd(y, min_y)));
+        __m128d gt=_mm_or_pd(_mm_cmpgt_pd(x, max_x), _mm_and_pd(_mm_cmpeq_pd(x, max_x), _mm_cmpgt_pd(y, max_y)));
+        min_x=blend(min_x, x, lt); min_y=blend(min_y, y, lt); min_i=blend(min_i, index, lt);
+        max_x=blend(max_x, x, gt); max_y=blend(max_y, y, gt); max_i=blend(max_i, index, gt);
+    }
+    double lanes[6][2];
+    _mm_storeu_pd(lanes[0], min_x); _mm_storeu_pd(lanes[1], min_y); _mm_storeu_pd(lanes[2], min_i);
+    _mm_storeu_pd(lanes[3], max_x); _mm_storeu_pd(lanes[4], max_y); _mm_storeu_pd(lanes[5], max_i);
+    int lo, hi;
+    reduce_extremes(lanes[0], lanes[1], lanes[2], lanes[3], lanes[4], lanes[5], 2, lo, hi);
+    for (; i<n; i++){
+        if (points[i]<points[lo]) lo=i;
+        if (points[hi]<points[i]) hi=i;
+    }
+    return {lo, hi};
+}
+
+__attribute__((target("avx2")))
+pair<int,int> extreme_points_avx2(const basic_point<double>* points, int n){
+    // The lanes hold the points in the order (0 2 1 3) of the unpacks, and so do the indices
+    const double* p=&points[0].x;
+    __m256d v0=_mm256_loadu_pd(p), v1=_mm256_loadu_pd(p+4);
+    __m256d min_x=_mm256_unpacklo_pd(v0, v1), min_y=_mm256_unpackhi_pd(v0, v1), min_i=_mm256_set_pd(3, 1, 2, 0);
+    __m256d max_x=min_x, max_y=min_y, max_i=min_i;
+    __m256d index=min_i;
+    const __m256d step=_mm256_set1_pd(4);
+    int i=4;
+    for (; i+4<=n; i+=4){
+        v0=_mm256_loadu_pd(p+2*i);
+        v1=_mm256_loadu_pd(p+2*i+4);
+        __m256d x=_mm256_unpacklo_pd(v0, v1), y=_mm256_unpackhi_pd(v0, v1);
+        index=_mm256_add_pd(index, step);
+        __m256d lt=_mm256_or_pd(_mm256_cmp_pd(x, min_x, _CMP_LT_OQ), _mm256_and_pd(_mm256_cmp_pd(x, min_x, _CMP_EQ_OQ), _mm256_cmp_pd(y, min_y, _CMP_LT_OQ)));
+        __m256d gt=_mm256_or_pd(_mm256_cmp_pd(x, max_x, _CMP_GT_OQ), _mm256_and_pd(_mm256_cmp_pd(x, max_x, _CMP_EQ_OQ), _mm256_cmp_pd(y, max_y, _CMP_GT_OQ)));
+        min_x=_mm256_blendv_pd(min_x, x, lt); min_y=_mm256_blendv_pd(min_y, y, lt); min_i=_mm256_blendv_pd(min_i, index, lt);
+        max_x=_mm256_blendv_pd(max_x, x, gt); max_y=_mm256_blendv_pd(max_y, y, gt); max_i=_mm256_blendv_pd(max_i, index, gt);
+    }
+    double lanes[6][4];
+    _mm256_storeu_pd(lanes[0], min_x); _mm256_storeu_pd(lanes[1], min_y); _mm256_storeu_pd(lanes[2], min_i);
+    _mm256_storeu_pd(lanes[3], max_x); _mm256_storeu_pd(lanes[4], max_y); _mm256_storeu_pd(lanes[5], max_i);
+    int lo, hi;
+    reduce_extremes(lanes[0], lanes[1], lanes[2], lanes[3], lanes[4], lanes[5], 4, lo, hi);
+    for (; i<n; i++){
+        if (points[i]<points[lo]) lo=i;
+        if (points[hi]<points[i]) hi=i;
+    }
+    return {lo, hi};
+}
+
+__attribute__((target("avx512f")))
+pair<int,int> extreme_points_avx512(const basic_point<double>* points, int n){
+    const double* p=&points[0].x;
+    const __m512i even=_mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0), odd=_mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+    __m512d v0=_mm512_loadu_pd(p), v1=_mm512_loadu_pd(p+8);
+    __m512d min_x=_mm512_permutex2var_pd(v0, even, v1), min_y=_mm512_permutex2var_pd(v0, odd, v1);
+    __m512d min_i=_mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0);
+    __m512d max_x=min_x, max_y=min_y, max_i=min_i;
+    __m512d index=min_i;
+    const __m512d step=_mm512_set1_pd(8);
+    int i=8;
+    for (; i+8<=n; i+=8){
+        v0=_mm512_loadu_pd(p+2*i);
+        v1=_mm512_loadu_pd(p+2*i+8);
+        __m512d x=_mm512_permutex2var_pd(v0, even, v1), y=_mm512_permutex2var_pd(v0, odd, v1);
+        index=_mm512_add_pd(index, step);
+        __mmask8 lt=_mm512_cmp_pd_mask(x, min_x, _CMP_LT_OQ) | (_mm512_cmp_pd_mask(x, min_x, _CMP_EQ_OQ) & _mm512_cmp_pd_mask(y, min_y, _CMP_LT_OQ));
+        __mmask8 gt=_mm512_cmp_pd_mask(x, max_x, _CMP_GT_OQ) | (_mm512_cmp_pd_mask(x, max_x, _CMP_EQ_OQ) & _mm512_cmp_pd_mask(y, max_y, _CMP_GT_OQ));
+        min_x=_mm512_mask_blend_pd(lt, min_x, x); min_y=_mm512_mask_blend_pd(lt, min_y, y); min_i=_mm512_mask_blend_pd(lt, min_i, index);
+        max_x=_mm512_mask_blend_pd(gt, max_x, x); max_y=_mm512_mask_blend_pd(gt, max_y, y); max_i=_mm512_mask_blend_pd(gt, max_i, index);
+    }
+    double lanes[6][8];
+    _mm512_storeu_pd(lanes[0], min_x); _mm512_storeu_pd(lanes[1], min_y); _mm512_storeu_pd(lanes[2], min_i);
+    _mm512_storeu_pd(lanes[3], max_x); _mm512_storeu_pd(lanes[4], max_y); _mm512_storeu_pd(lanes[5], max_i);
+    int lo, hi;
+    reduce_extremes(lanes[0], lanes[1], lanes[2], lanes[3], lanes[4], lanes[5], 8, lo, hi);
+    for (; i<n; i++){
+        if (points[i]<points[lo]) lo=i;
+        if (points[hi]<points[i]) hi=i;
+    }
+    return {lo, hi};
+}
+#endif
+
+template <typename T>
+void orient_batch(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>* points, int n, int8_t* signs){
+    // signs[i] = orient_filtered(a, b, points[i]) : 1 or -1 when certain, 0 otherwise
+    #ifdef __x86_64__
+        if constexpr (is_same_v<T,double>){
+            switch (simd_dispatch)
+            {
+            case SIMD_AVX512:
+                return orient_batch_avx512(a, b, points, n, signs);
+            case SIMD_AVX2:
+                return orient_batch_avx2(a, b, points, n, signs);
+            case SIMD_SSE2:
+                return orient_batch_sse2(a, b, points, n, signs);
+            default:
+                break;
+            }
+        }
+    #endif
+    forn(i,n) signs[i]=orient_filtered(a, b, points[i]);
+}
+
+template <typename T>
+void orient_signs(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>* points, int n, int8_t* signs){
+    // Exact signs of orient(a, b, points[i]), the uncertain ones being recomputed by orient_sign
+    orient_batch(a, b, points, n, signs);
+    STATS_ADD(orient_tests, n);
+    forn(i,n) if (signs[i]==0) signs[i]=orient_sign(a, b, points[i]);
+}
+
+const int KERNEL_BLOCK=64; // Points tested at once by the kernels that can stop early
+
+template <typename T>
+int skip_clockwise(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>* points, int from, int n){
+    // First index in [from, n) of a point which is not certainly clockwise from (a, b), that is below
+    // the line for a < b. Returns n if there is none. Only the tests up to that point are counted.
+    bool vector_kernel=false;
+    #ifdef __x86_64__
+        vector_kernel=is_same_v<T,double> && simd_dispatch>=SIMD_SSE2;
+    #endif
+    if (!vector_kernel){
+        for (int i=from; i<n; i++) if (orient_filtered(a, b, points[i])>=0){
+            STATS_ADD(orient_tests, i-from+1);
+            return i;
+        }
+        STATS_ADD(orient_tests, n-from);
+        return n;
+    }
+    // The blocks start small and grow : the caller often stops at one of the first points
+    int8_t signs[KERNEL_BLOCK];
+    for (int i=from, block=4; i<n; i+=block, block=min(2*block, KERNEL_BLOCK)){
+        int size=min(block, n-i);
+        orient_batch(a, b, points+i, size, signs);
+        forn(j,size) if (signs[j]>=0){
+            STATS_ADD(orient_tests, i+j-from+1);
+            return i+j;
+        }
+    }
+    STATS_ADD(orient_tests, n-from);
+    return n;
+}
+
+template <typename T>
+pair<int,int> extreme_points(const basic_point<T>* points, int n){
+    // Indices of the first lexicographic minimum and of the first lexicographic maximum, as
+    // min_element and max_element. n must be positive.
+    #ifdef __x86_64__
+        if constexpr (is_same_v<T,double>){
+            if (simd_dispatch==SIMD_AVX512 && n>=8) return extreme_points_avx512(points, n);
+            if (simd_dispatch>=SIMD_AVX2 && n>=4) return extreme_points_avx2(points, n);
+            if (simd_dispatch>=SIMD_SSE2 && n>=2) return extreme_points_sse2(points, n);
+        }
+    #endif
+    int lo=0, hi=0;
+    for (int i=1; i<n; i++){
+        if (points[i]<points[lo]) lo=i;
+        if (points[hi]<points[i]) hi=i;
+    }
+    return {lo, hi};
+}
+
+/* Part 3 : Sweeping */
+
+// All the hull algorithms are templated on the scalar type T (float, double or long double, or the
+// fixed-point int32_t and int64_t). The generators produce points with the default scalar 'ld',
+// convert_points and quantize_points change it.
+
+template <typename T>
+T cross(const basic_point<T>& a, const basic_point<T>& b){return a.x*b.y-a.y*b.x;}
+
+template <typename T>
+bool orient(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>& c){
+    // Returns 1 if clockwise or collinear and 0 if counter-clockwise.
+    // Stems from a x b = ||a|| ||b|| sin(theta) where x is cross product
+    return (orient_sign(a, b, c)<=0); //Negative means theta is negative means angle is clockwise 
+}
+
+template <typename T>
+bool point_cmp(const basic_point<T>& a, const basic_point<T>& b){
+    // Lexicographic order used by the sweeping : increasing x, then increasing y
+    if (a.x==b.x) return a.y<b.y;
+    return a.x<b.x;
+}
+
+// Pre-sort of the sweeping. Large inputs are sorted by an LSD radix sort on 64 bits keys which
+// preserve the lexicographic order : the key of x then the key of y for float and int32_t, the key of x
+// for double and int64_t, and the sign, exponent and 48 leading bits of x for long double. Points with the same key (same x,
+// or long doubles too close) are then sorted by comparison, which is rare except for duplicates and
+// vertical lines. Input that is already sorted, or nearly, is detected first.
+
+// Below this number of points per thread, threads cost more than they save and we stay serial
+const int PARALLEL_GRAIN=1<<14;
+
+const int RADIX_MIN=1<<10;     // Smaller inputs are sorted by std::sort
+const int RADIX_BITS=8;        // Bits of a digit : 8 passes, of which the constant digits are skipped
+const int NEARLY_SORTED=64;    // Input with less than n/NEARLY_SORTED descents is nearly sorted
+
+// Order-preserving keys of the scalars : a < b implies key(a) <= key(b). -0 becomes +0 (by adding 0),
+// since the points compare equal.
+inline uint32_t scalar_key(float v){
+    v+=0.f;
+    uint32_t u;
+    memcpy(&u, &v, 4);
+    return (u>>31) ? ~u : u|(1u<<31);
+}
+
+inline uint64_t scalar_key(double v){
+    v+=0.;
+    uint64_t u;
+    memcpy(&u, &v, 8);
+    return (u>>63) ? ~u : u|(1ULL<<63);
+}
+
+#ifdef __x86_64__
+inline uint64_t scalar_key(ld v){
+    // x87 extended precision : 64 bits of mantissa with an explicit integer bit, then 16 bits of sign
+    // and exponent. The integer bit only depends on the exponent and is dropped.
+    static_assert(numeric_limits<ld>::digits==64, "The radix keys expect the x87 long double");
+    v+=0.L;
+    uint64_t mantissa;
+    uint16_t sign_exponent;
+    memcpy(&mantissa, &v, 8);
+    memcpy(&sign_exponent, (char*)&v+8, 2);
+    uint64_t key=((uint64_t)sign_exponent<<48)|((mantissa<<1)>>16);
+    return (sign_exponent>>15) ? ~key : key|(1ULL<<63);
+}
+#endif
+
+inline uint32_t scalar_key(int32_t v){
+    return (uint32_t)v^(1u<<31);
+}
+
+inline uint64_t scalar_key(int64_t v){
+    return (uint64_t)v^(1ULL<<63);
+}
+
+// For 32 bits scalars the key is the whole point and there are no ties to sort
+template <typename T>
+constexpr bool key_is_point=sizeof(T)==4;
+
+// The long double only has exact keys in the x87 format. Elsewhere its key is the one of the nearest
+// double : it still orders the points, up to more ties, which the searches break by comparing the points,
+// but sort_points does not use the radix sort.
+template <typename T>
+constexpr bool exact_key=
+#ifdef __x86_64__
+    true;
+#else
+    !is_same_v<T,ld>;
+#endif
+
+template <typename T>
+uint64_t point_key(const basic_point<T>& p){
+    if constexpr (key_is_point<T>) return ((uint64_t)scalar_key(p.x)<<32)|scalar_key(p.y);
+    else if constexpr (exact_key<T>) return scalar_key(p.x);
+    else return scalar_key((double)p.x);
+}
+
+struct radix_item{
+    uint64_t key;
+    uint32_t index;
+};
+
+const int RADIX_BUCKETS=1<<RADIX_BITS, RADIX_DIGITS=64/RADIX_BITS;
+
+// Work buffers of sort_points. Kept from one call to the next, they make the sort free of allocations
+// once they are large enough.
+template <typename T>
+struct sort_scratch{
+    vector<radix_item> items, buffer;
+    vector<basic_point<T>> points; // Gathered points, or the merge of nearly sorted input
+    vector<array<array<int,RADIX_BUCKETS>,RADIX_DIGITS>> counts;
+    vector<array<int,RADIX_BUCKETS>> places;
+    vector<int> bounds;
+};
+
+template <typename T>
+void radix_sort_points(basic_point<T>* first, basic_point<T>* last, int nb_threads, sort_scratch<T>& scratch){
+    // Sorts [first, last) in lexicographic order. The (key, index) items are sorted, then the points are
+    // gathered in their order. Every pass of the parallel version counts the digits of each chunk, then
+    // every thread scatters its chunk to the places given by the counts.
+    const int BUCKETS=RADIX_BUCKETS, NB_DIGITS=RADIX_DIGITS;
+    int n=last-first;
+    nb_threads=max(1, min(nb_threads, n/PARALLEL_GRAIN));
+    auto& bounds=scratch.bounds;
+    bounds.resize(nb_threads+1);
+    forn(t,nb_threads+1) bounds[t]=(int)((long long)n*t/nb_threads);
+    auto run=[&](auto&& job){
+        vector<thread> workers;
+        for (int t=1; t<nb_threads; t++) workers.emplace_back(job, t);
+        job(0);
+        for (auto& w : workers) w.join();
+    };
+
+    // Keys and the counts of every digit of every key, in one read of the points
+    auto& items=scratch.items;
+    auto& buffer=scratch.buffer;
+    auto& counts=scratch.counts;
+    items.resize(n);
+    buffer.resize(n);
+    counts.resize(nb_threads);
+    run([&](int t){
+        auto& count=counts[t];
+        for (auto& c : count) c.fill(0);
+        for (int i=bounds[t]; i<bounds[t+1]; i++){
+            uint64_t key=point_key(first[i]);
+            items[i]={key, (uint32_t)i};
+            forn(d,NB_DIGITS) count[d][(key>>(d*RADIX_BITS))&(BUCKETS-1)]++;
+        }
+    });
+
+    auto& places=scratch.places;
+    places.resize(nb_threads);
+    bool moved=false;
+    forn(d,NB_DIGITS){
+        int shift=d*RADIX_BITS;
+        // A digit that is the same for every key would not move anything
+        bool constant=false;
+        forn(b,BUCKETS){
+            int total=0;
+            forn(t,nb_threads) total+=counts[t][d][b];
+            constant|=(total==n);
+        }
+        if (constant) continue;
+        if (moved && nb_threads>1){
+            // The items moved since the first counts : count the digit of each chunk again
+            run([&](int t){
+                auto& count=counts[t][d];
+                count.fill(0);
+                for (int i=bounds[t]; i<bounds[t+1]; i++) count[(items[i].key>>shift)&(BUCKETS-1)]++;
+            });
+        }
+        // Place of the first item of each chunk for each digit : by digit, then by chunk
+        int place=0;
+        forn(b,BUCKETS) forn(t,nb_threads){
+            places[t][b]=place;
+            place+=counts[t][d][b];
+        }
+        run([&](int t){
+            auto& place=places[t];
+            for (int i=bounds[t]; i<bounds[t+1]; i++) buffer[place[(items[i].key>>shift)&(BUCKETS-1)]++]=items[i];
+        });
+        swap(items, buffer);
+        moved=true;
+    }
+
+    // Gather the points, then sort the runs of equal keys by comparison. A run is sorted by the thread of
+    // the chunk where it starts.
+    auto& sorted=scratch.points;
+    sorted.resize(n);
+    run([&](int t){
+        for (int i=bounds[t]; i<bounds[t+1]; i++) sorted[i]=first[items[i].index];
+    });
+    run([&](int t){
+        copy(sorted.begin()+bounds[t], sorted.begin()+bounds[t+1], first+bounds[t]);
+    });
+    if constexpr (key_is_point<T>) return; // The keys are the whole points
+    run([&](int t){
+        int i=bounds[t];
+        while (i>0 && i<bounds[t+1] && items[i].key==items[i-1].key) i++;
+        while (i<bounds[t+1]){
+            int j=i+1;
+            while (j<n && items[j].key==items[i].key) j++;
+            if (j-i>1) sort(first+i, first+j, point_cmp<T>);
+            i=j;
+        }
+    });
+}
+
+template <typename T>
+void sort_points(basic_point<T>* first, basic_point<T>* last, int nb_threads=1, sort_scratch<T>* scratch=nullptr){
+    // Lexicographic sort of the points for the sweeping : nothing to do on sorted input, nearly sorted
+    // input is split into a sorted sequence and the few points out of place, which are sorted then
+    // merged back, and the rest goes to the radix sort. Without 'scratch', the work buffers are local.
+    sort_scratch<T> local;
+    if (scratch==nullptr) scratch=&local;
+    int n=last-first;
+    if (n<RADIX_MIN){
+        sort(first, last, point_cmp<T>);
+        return;
+    }
+    // Descents are counted until there are too many for the input to be nearly sorted, which for
+    // random input happens after a few hundred points
+    int descents=0, limit=n/NEARLY_SORTED;
+    for (int i=1; i<n && descents<=limit; i++) descents+=point_cmp(first[i], first[i-1]);
+    if (descents==0) return;
+    if (descents<=limit){
+        // At a descent, either the new point is too small, or the last kept point was too large : the
+        // one which does not fit after the point before it is set aside
+        auto& misplaced=scratch->points;
+        misplaced.clear();
+        basic_point<T>* kept=first+1;
+        basic_point<T>* p=first+1;
+        for (; p!=last && (int)misplaced.size()<=2*limit; ++p){
+            if (!point_cmp(*p, kept[-1])) *kept++=*p;
+            else if (kept-first==1 || !point_cmp(*p, kept[-2])){
+                misplaced.push_back(kept[-1]);
+                kept[-1]=*p;
+            }
+            else misplaced.push_back(*p);
+        }
+        // Points after the set-aside ones, left as they are if there were too many of them
+        basic_point<T>* rest=copy(p, last, kept);
+        copy(all(misplaced), rest);
+        if (p==last){
+            sort_points(kept, last, nb_threads, scratch);
+            misplaced.resize(n);
+            merge(first, kept, kept, last, misplaced.begin(), point_cmp<T>);
+            copy(all(misplaced), first);
+            return;
+        }
+    }
+    if constexpr (exact_key<T>) radix_sort_points(first, last, nb_threads, *scratch);
+    else sort(first, last, point_cmp<T>);
+}
+
+template <typename It, typename Hull, typename Observer=null_observer>
+void sweep_pass(It first, It last, Hull& hull, Observer&& observer=Observer()){
+    // One pass of the sweeping over [first, last), pushing the points into 'hull' (a vector, or a
+    // point_stack). Only the points that keep the chain clockwise stay in 'hull' at the end.
+    using P=typename Hull::value_type;
+    auto turn=[&](const P& a, const P& b, const P& c){
+        // Same as orient(a,b,c), the sign is reported to the observer
+        int sign=orient_sign(a, b, c);
+        observer.orient(a, b, c, sign);
+        return sign<=0;
+    };
+    observer.chain();
+    for (It it=first; it!=last; ++it){
+        if(!hull.empty() && hull.back()==*it){
+            // A repeated point would make orient() always true and the chain could not pop past it anymore
+            continue;
+        }
+        // Pop the last point while c is not to its right side, each orientation being tested and
+        // reported once
+        P c=*it;
+        while ((int)(hull.size())>=2 && !turn(hull[hull.size()-2], hull[hull.size()-1], c)){
+            observer.pop(hull.back());
+            STATS_ADD(pops, 1);
+            hull.pop_back(); // Remove the last point of the hull
+        }
+        hull.push_back(c);
+        observer.push(c);
+    }
+}
+
+template <typename T, typename Observer=null_observer>
+vector<basic_point<T>> convex_hull_sweeping(basic_point<T>* first, basic_point<T>* last, Observer&& observer=Observer()){
+    {
+        STATS_TIMER(PHASE_SORT);
+        sort_points(first, last); // Sort points by increasing x
+    }
+    STATS_TIMER(PHASE_CHAINS);
+    vector<basic_point<T>> hull_up;
+    vector<basic_point<T>> hull_down;
+    // Increasing x pass
+    sweep_pass(first, last, hull_up, observer);
+    // Decreasing x pass. If everything went well the rightmost point and leftmost point are in the hull so it's no use to consider them
+    sweep_pass(make_reverse_iterator(last), make_reverse_iterator(first), hull_down, observer);
+    for (int j=1;j<(int)(hull_down.size())-1;j++) hull_up.push_back(hull_down[j]);
+    return hull_up;
+}
+
+template <typename T, typename Observer=null_observer>
+vector<basic_point<T>> convex_hull_sweeping(vector<basic_point<T>>& points, Observer&& observer=Observer()){
+    return convex_hull_sweeping(points.data(), points.data()+points.size(), observer);
+}
+
+template <typename T>
+vector<basic_point<T>> convex_hull_sweeping(mapped_points<T>& points){
+    // Runs directly on the mapped file, the points are sorted in the private mapping
+    return convex_hull_sweeping(points.begin(), points.end());
+}
+
+// The sweeping without allocations : both chains are stacks in one buffer of the caller, which is
+// reused from one call to the next, and so are the buffers of the sort. The upper chain starts at the
+// beginning of the buffer and the lower one at the last point of the upper one, which is also its first
+// point. n+1 points are enough, unless the input is collinear (its points are then on both chains).
+
+// A view of points in a buffer, valid until the buffer is used again
+template <typename T>
+struct point_span{
+    basic_point<T>* first;
+    basic_point<T>* last;
+
+    basic_point<T>* begin() const { return first; }
+    basic_point<T>* end() const { return last; }
+    size_t size() const { return last-first; }
+    bool empty() const { return first==last; }
+    basic_point<T>& operator[](size_t i) const { return first[i]; }
+};
+
+// A chain of the sweeping, kept as a stack in 'buffer' from the index 'start'. The buffer grows if needed.
+template <typename T>
+struct point_stack{
+    using value_type=basic_point<T>;
+
+    vector<basic_point<T>>& buffer;
+    size_t start;
+    size_t count=0;
+
+    void push_back(const basic_point<T>& p){
+        if (start+count==buffer.size()) buffer.resize(2*buffer.size());
+        buffer[start+count++]=p;
+    }
+    void pop_back() { count--; }
+    const basic_point<T>& back() const { return buffer[start+count-1]; }
+    const basic_point<T>& operator[](size_t i) const { return buffer[start+i]; }
+    size_t size() const { return count; }
+    bool empty() const { return count==0; }
+};
+
+template <typename T>
+struct sweep_workspace{
+    vector<basic_point<T>> hull;
+    sort_scratch<T> sort;
+};
+
+template <typename T, typename Observer=null_observer>
+point_span<T> convex_hull_sweeping_into(basic_point<T>* first, basic_point<T>* last, sweep_workspace<T>& workspace, Observer&& observer=Observer()){
+    // Same hull as convex_hull_sweeping, in workspace.hull
+    {
+        STATS_TIMER(PHASE_SORT);
+        sort_points(first, last, 1, &workspace.sort);
+    }
+    STATS_TIMER(PHASE_CHAINS);
+    vector<basic_point<T>>& buffer=workspace.hull;
+    size_t n=last-first;
+    if (n==0) return {buffer.data(), buffer.data()};
+    if (buffer.size()<n+1) buffer.resize(n+1);
+    point_stack<T> hull_up{buffer, 0};
+    sweep_pass(first, last, hull_up, observer);
+    point_stack<T> hull_down{buffer, hull_up.size()-1};
+    sweep_pass(make_reverse_iterator(last), make_reverse_iterator(first), hull_down, observer);
+    // The lower chain ends with the first point of the upper one
+    size_t size=hull_up.size()+max<size_t>(hull_down.size(), 2)-2;
+    return {buffer.data(), buffer.data()+size};
+}
+
+template <typename T, typename Observer=null_observer>
+point_span<T> convex_hull_sweeping_into(vector<basic_point<T>>& points, sweep_workspace<T>& workspace, Observer&& observer=Observer()){
+    return convex_hull_sweeping_into(points.data(), points.data()+points.size(), workspace, observer);
+}
+
+// Walks over a point_soa, building the points on the fly from the x and y buffers
+template <typename T>
+struct soa_iterator{
+    using iterator_category = bidirectional_iterator_tag;
+    using value_type = basic_point<T>;
+    using difference_type = ptrdiff_t;
+    using pointer = void;
+    using reference = basic_point<T>;
+
+    const T* x;
+    const T* y;
+
+    basic_point<T> operator*() const {return {*x, *y};}
+    soa_iterator& operator++(){++x; ++y; return *this;}
+    soa_iterator& operator--(){--x; --y; return *this;}
+    bool operator==(const soa_iterator& other) const {return x==other.x;}
+    bool operator!=(const soa_iterator& other) const {return x!=other.x;}
+};
+
+template <typename T>
+void sort_soa(point_soa<T>& points){
+    // Sorts the indices, then gathers both buffers in that order
+    int n=points.size();
+    vector<uint32_t> order(n);
+    forn(i,n) order[i]=i;
+    sort(all(order), [&points](uint32_t i, uint32_t j){
+        if (points.x[i]==points.x[j]) return points.y[i]<points.y[j];
+        return points.x[i]<points.x[j];
+    });
+    vector<T> x(n), y(n);
+    forn(i,n){
+        x[i]=points.x[order[i]];
+        y[i]=points.y[order[i]];
+    }
+    points.x.swap(x);
+    points.y.swap(y);
+}
+
+template <typename T>
+vector<basic_point<T>> convex_hull_sweeping(point_soa<T>& points){
+    // Same as above on the structure-of-arrays layout. The hull is small so it is returned as points.
+    {
+        STATS_TIMER(PHASE_SORT);
+        sort_soa(points);
+    }
+    STATS_TIMER(PHASE_CHAINS);
+    soa_iterator<T> first{points.x.data(), points.y.data()};
+    soa_iterator<T> last{points.x.data()+points.size(), points.y.data()+points.size()};
+    vector<basic_point<T>> hull_up;
+    vector<basic_point<T>> hull_down;
+    sweep_pass(first, last, hull_up);
+    sweep_pass(make_reverse_iterator(last), make_reverse_iterator(first), hull_down);
+    for (int j=1;j<(int)(hull_down.size())-1;j++) hull_up.push_back(hull_down[j]);
+    return hull_up;
+}
+
+/* Part 3 bis : Parallel sweeping */
+
+template <typename T>
+vector<basic_point<T>> convex_hull_sweeping_parallel(vector<basic_point<T>>& points, int nb_threads=thread::hardware_concurrency()){
+    // Same contract as convex_hull_sweeping : sorts 'points' and returns the exact same hull.
+    // Every thread runs both passes on its own chunk of the sorted points. A point dropped from the
+    // chain of its chunk is strictly inside the hull, so running the serial passes again on the
+    // concatenation of the partial chains gives the same result as running them on all the points.
+    int n=points.size();
+    nb_threads=max(1, min(nb_threads, n/PARALLEL_GRAIN));
+    if (nb_threads==1) return convex_hull_sweeping(points);
+
+    {
+        STATS_TIMER(PHASE_SORT);
+        sort_points(points.data(), points.data()+n, nb_threads);
+    }
+    STATS_TIMER(PHASE_CHAINS);
+    vector<vector<basic_point<T>>> chunk_up(nb_threads), chunk_down(nb_threads);
+    vector<thread> workers;
+    forn(t,nb_threads) workers.emplace_back([&, t](){
+        auto first=points.begin()+(long long)n*t/nb_threads;
+        auto last=points.begin()+(long long)n*(t+1)/nb_threads;
+        sweep_pass(first, last, chunk_up[t]);
+        sweep_pass(make_reverse_iterator(last), make_reverse_iterator(first), chunk_down[t]);
+    });
+    for (auto& w : workers) w.join();
+
+    // Merge the partial chains : increasing x for the upper one, decreasing x for the lower one
+    vector<basic_point<T>> candidates_up, candidates_down;
+    forn(t,nb_threads) candidates_up.insert(candidates_up.end(), all(chunk_up[t]));
+    for (int t=nb_threads-1;t>=0;t--) candidates_down.insert(candidates_down.end(), all(chunk_down[t]));
+    vector<basic_point<T>> hull_up;
+    vector<basic_point<T>> hull_down;
+    sweep_pass(candidates_up.begin(), candidates_up.end(), hull_up);
+    sweep_pass(candidates_down.begin(), candidates_down.end(), hull_down);
+    for (int j=1;j<(int)(hull_down.size())-1;j++) hull_up.push_back(hull_down[j]);
+    return hull_up;
+}
+
+template <typename T>
+class MedianList {
+private:
+    using list_t = std::vector<T>;
+
+    // All the functions below work in place on [first, last) and never allocate. Elements are only
+    // compared with operator<, two elements being equal when neither is below the other.
+
+    // Sorts a small range (at most a group of 5) by insertion.
+    template <typename It>
+    static void insertionSort(It first, It last) {
+        for (It i = first; i != last; ++i)
+            for (It j = i; j != first && *j < *std::prev(j); --j)
+                std::iter_swap(j, std::prev(j));
+    }
+
+    // Three-way partition of [first, last) around 'pivot'. Returns the offsets (lt, gt) such that
+    // [first, first + lt) < pivot, [first + lt, first + gt) == pivot and [first + gt, last) > pivot.
+    template <typename It>
+    static std::pair<int, int> partition(It first, It last, const T& pivot) {
+        int lt = 0, i = 0, gt = last - first;
+        while (i < gt) {
+            if (first[i] < pivot)
+                std::iter_swap(first + lt++, first + i++);
+            else if (pivot < first[i])
+                std::iter_swap(first + i, first + --gt);
+            else
+                ++i;
+        }
+
+        return std::pair(lt, gt);
+    }
+
+    // Rearranges [first, last) so that first[k] is the element of rank k (0-indexed), with smaller
+    // elements before it and larger ones after it. Worst-case linear thanks to the median of medians.
+    template <typename It>
+    static void quickSelect(It first, It last, int k) {
+        while (last - first > 5) {
+            T pivot{ findMedianOfMedians(first, last) };
+            auto [lt, gt] = partition(first, last, pivot);
+            if (k < lt) {
+                last = first + lt;
+            }
+            else if (k >= gt) {
+                first += gt;
+                k -= gt;
+            }
+            else
+                return;
+        }
+        insertionSort(first, last);
+    }
+
+    // Sorts a group of at most 5 elements and returns its middle one.
+    template <typename It>
+    static It findMedianNaive(It first, It last) {
+        insertionSort(first, last);
+
+        return first + (last - first) / 2;
+    }
+
+    // Moves the medians of the groups of 5 to the front of the range, then selects their median.
+    template <typename It>
+    static T findMedianOfMedians(It first, It last) {
+        int n = last - first;
+        if (n <= 5)
+            return *findMedianNaive(first, last);
+        int nbGroups = 0;
+        for (int i = 0; i < n; i += 5)
+            std::iter_swap(first + nbGroups++, findMedianNaive(first + i, first + min(i + 5, n)));
+        quickSelect(first, first + nbGroups, nbGroups / 2);
+
+        return first[nbGroups / 2];
+    }
+
+public:
+    // Note: this function returns the lower middle element, which is below
+    // the median if the list has an even number of elements. This is
+    // intentional and is used in the convex hull algorithm : the median is
+    // one of the elements, so nothing is above it only if the elements above
+    // the middle are all equal to it.
+    // Works in place and reorders [first, last).
+    template <typename It>
+    static T findMedian(It first, It last) {
+        int n = last - first;
+        assert(n >= 2 && "findMedian needs at least 2 elements");
+        quickSelect(first, last, n / 2 - 1);
+        return first[n / 2 - 1];
+    }
+
+    // Same on a copy of 'lst', for the callers that need to keep its order.
+    static T findMedian(list_t lst) {
+        return findMedian(lst.begin(), lst.end());
+    }
+};
+
+// Scratch memory for one run of an algorithm. It is allocated once and handed
+// out like a stack : allocate() takes the next free block and release() gives
+// back a block and everything allocated after it.
+template <typename T>
+class Arena {
+private:
+    std::allocator<T> allocator;
+    T* buffer;
+    size_t capacity;
+    size_t used = 0;
+
+public:
+    Arena(size_t capacity): buffer{ allocator.allocate(capacity) }, capacity{ capacity } {}
+    ~Arena() { allocator.deallocate(buffer, capacity); }
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    T* allocate(size_t size) {
+        assert(used + size <= capacity && "The arena is too small");
+        T* block = buffer + used;
+        used += size;
+        return block;
+    }
+
+    void release(T* block) {
+        used = block - buffer;
+    }
+};
+
+// Work-stealing thread pool for fork-join parallelism. Each thread has its own
+// deque of tasks : it pushes and pops its own tasks at the back, and when it has
+// nothing to do it steals from the front of the others, or sleeps until a task
+// is spawned. The thread that creates the pool works as thread 0 while it waits
+// for a group of tasks, and any thread which is not a worker of the pool too.
+class ThreadPool {
+public:
+    // Counts the tasks of a group that are not finished yet.
+    struct TaskGroup {
+        std::atomic<int> pending{ 0 };
+    };
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+    // The idle threads sleep on 'idle' until a task is queued, a group is
+    // finished or the pool stops. These are changed with 'idleMutex' locked.
+    std::mutex idleMutex;
+    std::condition_variable idle;
+    std::atomic<int> queued{ 0 }; // Tasks in the queues
+    // Pool and queue of the current thread, if it is a worker
+    inline static thread_local const ThreadPool* owner = nullptr;
+    inline static thread_local int self = 0;
+
+    // Queue of the current thread in this pool.
+    int current() const {
+        return owner == this ? self : 0;
+    }
+
+    // Runs one task, from the own queue of thread 'index' or stolen from
+    // another one. Returns false if there was no task at all.
+    bool runOneTask(int index) {
+        std::function<void()> task;
+        {
+            std::lock_guard lock{ queues[index]->mutex };
+            if (!queues[index]->tasks.empty()) {
+                task = std::move(queues[index]->tasks.back());
+                queues[index]->tasks.pop_back();
+            }
+        }
+        for (int k = 1; !task && k < size(); ++k) {
+            Queue& victim = *queues[(index + k) % size()];
+            std::lock_guard lock{ victim.mutex };
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        if (!task)
+            return false;
+        queued--;
+        task();
+        return true;
+    }
+
+public:
+    ThreadPool(int nbThreads) {
+        nbThreads = max(1, nbThreads);
+        for (int i = 0; i < nbThreads; ++i)
+            queues.push_back(std::make_unique<Queue>());
+        for (int i = 1; i < nbThreads; ++i)
+            workers.emplace_back([this, i]() {
+                owner = this;
+                self = i;
+                while (true) {
+                    if (runOneTask(i))
+                        continue;
+                    std::unique_lock lock{ idleMutex };
+                    idle.wait(lock, [this]() { return stopping || queued > 0; });
+                    if (stopping)
+                        return;
+                }
+            });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock{ idleMutex };
+            stopping = true;
+        }
+        idle.notify_all();
+        for (auto& w : workers)
+            w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const {
+        return queues.size();
+    }
+
+    template <typename F>
+    void spawn(TaskGroup& group, F task) {
+        group.pending++;
+        {
+            Queue& queue = *queues[current()];
+            std::lock_guard lock{ queue.mutex };
+            queue.tasks.push_back([this, &group, task]() mutable {
+                task();
+                // The group can be destroyed as soon as it is finished
+                if (--group.pending == 0) {
+                    { std::lock_guard lock{ idleMutex }; }
+                    idle.notify_all();
+                }
+            });
+        }
+        {
+            std::lock_guard lock{ idleMutex };
+            queued++;
+        }
+        idle.notify_one();
+    }
+
+    // Runs tasks (of any group) until all the tasks of 'group' are done,
+    // sleeping while the last ones run on other threads.
+    void wait(TaskGroup& group) {
+        int index = current();
+        while (group.pending > 0) {
+            if (runOneTask(index))
+                continue;
+            std::unique_lock lock{ idleMutex };
+            idle.wait(lock, [&]() { return group.pending == 0 || queued > 0; });
+        }
+    }
+};
+
+// Encapsulates the functions related to the divide-and-conquer approach to
+// finding the convex hull.
+template <typename T, typename Observer = null_observer>
+class Algorithm2 {
+private:
+    using point = basic_point<T>;
+
+    std::vector<point> data;
+    Observer observer;
+    // True while the lower hull is computed, on the points rotated by a half-turn.
+    bool rotated = false;
+
+    // Coordinates of 'p' before the rotation, for the observer.
+    point shown(const point& p) const {
+        return rotated ? point(-p.x, -p.y) : p;
+    }
+public:
+    // Among the points of [first, first + k) on the other side of the line
+    // x = p_m.x from 'p', finds the one 'q' for which (p, q) crosses that line
+    // highest. Returns its index (the first one on ties), or -1 if there is
+    // none. Large scans are split in chunks run as tasks of 'pool'.
+    int findPartner(const point* first, int k, const point& p, const point& p_m, ThreadPool* pool) {
+        // Points are ordered lexicographically, as if the line was rotated by
+        // an infinitesimal angle : equal x coordinates are told apart by y.
+        // Points equal to p_m count as left of the line.
+        bool pLeft = !(p_m < p);
+        // Seen from 'p', the segment crossing the line highest is the furthest
+        // counter-clockwise one if the line is on its right, the furthest
+        // clockwise one otherwise. For 'p' equal to p_m, all the segments cross
+        // the line at 'p' and this keeps the one leaving it with the largest slope.
+        auto better = [&](int i, int best) {
+            if (best < 0)
+                return true;
+            int sign = orient_sign(p, first[best], first[i]);
+            return pLeft ? sign > 0 : sign < 0;
+        };
+        auto scan = [&](int from, int to, int& best) {
+            for (int i = from; i < to; ++i) {
+                if (!(p_m < first[i]) == pLeft)
+                    continue;
+                if (better(i, best))
+                    best = i;
+            }
+        };
+        int best = -1;
+        if (pool == nullptr || pool->size() == 1 || k < 2 * PARALLEL_GRAIN) {
+            scan(0, k, best);
+            return best;
+        }
+        int nbChunks = k / PARALLEL_GRAIN;
+        std::vector<int> chunkBest(nbChunks, -1);
+        ThreadPool::TaskGroup group;
+        for (int c = 0; c < nbChunks; ++c)
+            pool->spawn(group, [&, c]() { scan((long long)k * c / nbChunks, (long long)k * (c + 1) / nbChunks, chunkBest[c]); });
+        pool->wait(group);
+        // Chunks are merged in order, so that ties give the same point as the serial scan.
+        for (int c = 0; c < nbChunks; ++c)
+            if (chunkBest[c] >= 0 && better(chunkBest[c], best))
+                best = chunkBest[c];
+
+        return best;
+    }
+
+    // Finds the bridge (p1, p2) of the upper hull of [first, last) over the
+    // line x = p_m.x, adding the points one by one in their current order.
+    std::pair<point, point> findBridge(const point* first, const point* last, const point& p_m, ThreadPool* pool = nullptr) {
+        int n = last - first;
+        auto [argMin, argMax] = extreme_points(first, n);
+        point mini{ first[argMin] };
+        point maxi{ first[argMax] };
+
+        // Base points.
+        point p1{ mini }, p2{ maxi };
+
+        for (int k = 0; k < n; ++k) {
+            // Without an observer to report them to, the points certainly below the bridge are
+            // skipped by blocks.
+            if constexpr (!Observer::enabled) {
+                k = skip_clockwise(p1, p2, first, k, n);
+                if (k == n)
+                    break;
+            }
+            const point& p = first[k];
+            if (p == p1 || p == p2)
+                continue;
+            // Nothing changes if 'p' is not above the bridge.
+            int sign = orient_sign(p1, p2, p);
+            observer.orient(shown(p1), shown(p2), shown(p), sign);
+            if (sign <= 0)
+                continue;
+            // The bridge must go through 'p' : look for its other end among the previous points.
+            int partner = findPartner(first, k, p, p_m, pool);
+            p1 = p;
+            p2 = partner >= 0 ? first[partner] : (p_m < p ? mini : maxi);
+            if (p2 < p1)
+                swap(p1, p2);
+        }
+
+        return std::pair(p1, p2);
+    }
+
+    // Median selection and bridge search, timed for the statistics.
+    template <typename It>
+    static point median(It first, It last) {
+        STATS_TIMER(PHASE_MEDIAN);
+        return MedianList<point>::findMedian(first, last);
+    }
+
+    // On a copy, so that the order of the points stays random.
+    static point median(const std::vector<point>& points) {
+        STATS_TIMER(PHASE_MEDIAN);
+        return MedianList<point>::findMedian(points);
+    }
+
+    std::pair<point, point> timedBridge(const point* first, const point* last, const point& p_m, ThreadPool* pool = nullptr) {
+        STATS_TIMER(PHASE_BRIDGE);
+        return findBridge(first, last, p_m, pool);
+    }
+
+    // Subroutine for the main algorithm. Is used recursively.
+    std::vector<point> applyAlgorithm(std::vector<point> points, int depth = 0) {
+        STATS_DEPTH(depth);
+        if (points.size() <= 2) {
+            if (points.size() == 2 && points[1] < points[0])
+                swap(points[0], points[1]);
+            return points;
+        }
+        point p_m{ median(points) };
+        auto [p1, p2] = timedBridge(points.data(), points.data() + points.size(), p_m);
+        // All the points are the same.
+        if (p1 == p2)
+            return { p1 };
+        observer.bridge(shown(p1), shown(p2));
+
+        // Create recursive cases.
+        std::vector<point> res, lo, hi, mid;
+        {
+            STATS_TIMER(PHASE_PARTITION);
+            for (const auto& p : points) {
+                if (!(p1 < p))
+                    lo.push_back(p);
+                else if (!(p < p2))
+                    hi.push_back(p);
+                else if (orient_sign(p1, p2, p) == 0)
+                    mid.push_back(p);
+            }
+            std::sort(mid.begin(), mid.end());
+        }
+        std::vector<point> loPoints = applyAlgorithm(lo, depth + 1);
+        std::vector<point> hiPoints = applyAlgorithm(hi, depth + 1);
+
+        // Reconstitute the final answer.
+        for (const auto& p : loPoints)
+            res.push_back(p);
+        res.push_back(p1);
+        for (const auto& p : mid)
+            res.push_back(p);
+        res.push_back(p2);
+        for (const auto& p : hiPoints)
+            res.push_back(p);
+        
+        return res;
+    }
+
+    std::vector<point> startAlgorithm() {
+        observer.chain();
+        std::vector<point> res{ applyAlgorithm(data) };
+        int upperSize = res.size();
+
+        // Points rotated by a half-turn in order to find the lower hull.
+        std::vector<point> negData{ data };
+        for (auto& x : negData)
+            x = point(-x.x, -x.y);
+
+        observer.chain();
+        rotated = true;
+        std::vector<point> lower{ applyAlgorithm(negData) };
+        rotated = false;
+        res.insert(res.end(), lower.begin(), lower.end());
+        joinLowerHull(res, upperSize);
+
+        return res;
+    }
+
+    // Partition of [first, last) into [lo | hi | mid | others] for the bridge
+    // (p1, p2) : lo is compacted at the front, hi and the others go to
+    // 'scratch' (from its front and from its back) and are copied back. lo
+    // and hi keep their order. mid are the points strictly inside the bridge,
+    // which are on the hull as well : they are sorted. Returns the ends of
+    // lo, hi and mid.
+    std::tuple<point*, point*, point*> partitionAroundBridge(point* first, point* last, const point& p1, const point& p2, point* scratch) {
+        STATS_TIMER(PHASE_PARTITION);
+        int n = last - first;
+        point* loEnd = first;
+        int nbHi = 0, nbOthers = 0;
+        for (point* p = first; p != last; ++p) {
+            if (!(p1 < *p))
+                *loEnd++ = *p;
+            else if (!(*p < p2))
+                scratch[nbHi++] = *p;
+            else
+                scratch[n - ++nbOthers] = *p;
+        }
+        point* hiEnd = std::copy(scratch, scratch + nbHi, loEnd);
+        std::reverse_copy(scratch + n - nbOthers, scratch + n, hiEnd);
+        point* midEnd = std::partition(hiEnd, last, [&](const point& p) { return orient_sign(p1, p2, p) == 0; });
+        std::sort(hiEnd, midEnd);
+
+        return std::tuple(loEnd, hiEnd, midEnd);
+    }
+
+    // Appends 'p' to 'res' unless it is already its last point : a bridge
+    // point is also the last point of lo or the first one of hi.
+    static void appendPoint(std::vector<point>& res, const point& p) {
+        if (res.empty() || !(res.back() == p))
+            res.push_back(p);
+    }
+
+    // Turns 'res', the upper hull followed by the lower hull computed on the
+    // points rotated by a half-turn (from its 'upperSize'-th point), into the
+    // whole hull. The rotation reverses the lexicographic order : the lower
+    // hull goes from the last point of the upper hull back to its first one.
+    static void joinLowerHull(std::vector<point>& res, int upperSize) {
+        for (auto it = res.begin() + upperSize; it != res.end(); ++it)
+            *it = point(-it->x, -it->y);
+
+        // Delete redundance with the upper hull.
+        auto it { std::unique(res.begin(), res.end()) };
+        res.erase(it, res.end());
+        // The lower hull ends where the upper one starts.
+        if (res.size() > 1 && res.back() == res.front())
+            res.pop_back();
+    }
+
+    // Allocation-free version of applyAlgorithm on [first, last), a range of
+    // 'data'. The range is reordered in place as [lo | hi | others], scratch
+    // memory comes from 'arena' and the hull is appended to 'res'.
+    void applyAlgorithmInPlace(point* first, point* last, Arena<point>& arena, std::vector<point>& res, int depth = 0) {
+        STATS_DEPTH(depth);
+        int n = last - first;
+        if (n <= 2) {
+            if (n == 2 && first[1] < first[0])
+                swap(first[0], first[1]);
+            for (point* p = first; p != last; ++p)
+                appendPoint(res, *p);
+            return;
+        }
+
+        // The median is selected on a copy so that the order of the points stays random.
+        point* scratch = arena.allocate(n);
+        std::uninitialized_copy(first, last, scratch);
+        point p_m{ median(scratch, scratch + n) };
+        auto [p1, p2] = timedBridge(first, last, p_m);
+        if (p1 == p2) {
+            // All the points are the same.
+            arena.release(scratch);
+            appendPoint(res, p1);
+            return;
+        }
+        observer.bridge(shown(p1), shown(p2));
+
+        auto [loEnd, hiEnd, midEnd] = partitionAroundBridge(first, last, p1, p2, scratch);
+        arena.release(scratch);
+
+        applyAlgorithmInPlace(first, loEnd, arena, res, depth + 1);
+        appendPoint(res, p1);
+        for (point* p = hiEnd; p != midEnd; ++p)
+            appendPoint(res, *p);
+        appendPoint(res, p2);
+        applyAlgorithmInPlace(loEnd, hiEnd, arena, res, depth + 1);
+    }
+
+    // Same result as startAlgorithm, with the in-place recursion. The run
+    // allocates only its arena and the result buffer.
+    std::vector<point> startAlgorithmInPlace() {
+        int n = data.size();
+        Arena<point> arena(n);
+        // Each of the upper and lower hulls holds at most the n points, with the
+        // points inside its edges : all of them when the input is collinear.
+        std::vector<point> res;
+        res.reserve(2 * n);
+
+        // The points are added in random order when looking for the bridges.
+        std::shuffle(data.begin(), data.end(), rng);
+        observer.chain();
+        applyAlgorithmInPlace(data.data(), data.data() + n, arena, res);
+        int upperSize = res.size();
+
+        // Points rotated by a half-turn in order to find the lower hull.
+        for (auto& x : data)
+            x = point(-x.x, -x.y);
+        std::shuffle(data.begin(), data.end(), rng);
+        observer.chain();
+        rotated = true;
+        applyAlgorithmInPlace(data.data(), data.data() + n, arena, res);
+        rotated = false;
+        for (auto& x : data)
+            x = point(-x.x, -x.y);
+        joinLowerHull(res, upperSize);
+
+        return res;
+    }
+
+    // Parallel version of applyAlgorithmInPlace. Above 'grain' points, lo and
+    // hi are solved as tasks of 'pool' and the bridge scan is split across its
+    // threads. The hull of the range is returned since tasks end in any order.
+    std::vector<point> applyAlgorithmParallel(point* first, point* last, ThreadPool& pool, int grain, int depth = 0) {
+        STATS_DEPTH(depth);
+        int n = last - first;
+        std::vector<point> res;
+        if (n <= grain) {
+            Arena<point> arena(n);
+            res.reserve(n);
+            applyAlgorithmInPlace(first, last, arena, res, depth);
+            return res;
+        }
+
+        std::vector<point> scratch(first, last);
+        point p_m{ median(scratch.begin(), scratch.end()) };
+        auto [p1, p2] = timedBridge(first, last, p_m, &pool);
+        if (p1 == p2) {
+            // All the points are the same.
+            res.push_back(p1);
+            return res;
+        }
+        auto [loEnd, hiEnd, midEnd] = partitionAroundBridge(first, last, p1, p2, scratch.data());
+        scratch = std::vector<point>();
+
+        std::vector<point> loPoints, hiPoints;
+        ThreadPool::TaskGroup group;
+        pool.spawn(group, [&]() { loPoints = applyAlgorithmParallel(first, loEnd, pool, grain, depth + 1); });
+        hiPoints = applyAlgorithmParallel(loEnd, hiEnd, pool, grain, depth + 1);
+        pool.wait(group);
+
+        // Reconstitute the final answer.
+        res.reserve(loPoints.size() + (midEnd - hiEnd) + hiPoints.size() + 2);
+        for (const auto& p : loPoints)
+            appendPoint(res, p);
+        appendPoint(res, p1);
+        for (point* p = hiEnd; p != midEnd; ++p)
+            appendPoint(res, *p);
+        appendPoint(res, p2);
+        for (const auto& p : hiPoints)
+            appendPoint(res, p);
+
+        return res;
+    }
+
+    // Same result as startAlgorithmInPlace on 'nbThreads' threads. The upper
+    // and lower hulls are computed at the same time, on two copies of the data.
+    // Subproblems of at most 'grain' points are solved serially.
+    std::vector<point> startAlgorithmParallel(int nbThreads = std::thread::hardware_concurrency(), int grain = PARALLEL_GRAIN) {
+        static_assert(!Observer::enabled, "Observers are not thread-safe, use startAlgorithm or startAlgorithmInPlace");
+        ThreadPool pool(nbThreads);
+        std::shuffle(data.begin(), data.end(), rng);
+        // Points rotated by a half-turn in order to find the lower hull.
+        std::vector<point> negData{ data };
+        for (auto& x : negData)
+            x = point(-x.x, -x.y);
+
+        std::vector<point> res, lower;
+        ThreadPool::TaskGroup group;
+        pool.spawn(group, [&]() { lower = applyAlgorithmParallel(negData.data(), negData.data() + negData.size(), pool, grain); });
+        res = applyAlgorithmParallel(data.data(), data.data() + data.size(), pool, grain);
+        pool.wait(group);
+
+        int upperSize = res.size();
+        res.insert(res.end(), lower.begin(), lower.end());
+        joinLowerHull(res, upperSize);
+
+        return res;
+    }
+
+    Algorithm2(std::vector<point> points, Observer observer = Observer()): data{ points }, observer{ observer } {}
+
+    Observer& getObserver() {
+        return observer;
+    }
+
+    // The structure-of-arrays layout is gathered once into the working buffer
+    Algorithm2(const point_soa<T>& points) {
+        data.reserve(points.size());
+        for (size_t i = 0; i < points.size(); ++i)
+            data.push_back(points[i]);
+    }
+};
+
+/* Part 4 : Akl-Toussaint prefilter */
+
+// Optional stage to run before any of the hull algorithms. The extreme points in the 8 directions
+// (x, y, x+y, x-y, minimum and maximum) are on the hull, so every point strictly inside the octagon
+// they form is not, and can be dropped in O(n). On uniform datasets (B, C) this removes most points.
+
+template <typename T>
+vector<basic_point<T>> extreme_octagon(const vector<basic_point<T>>& points, int nb_threads){
+    // Returns the vertices of the octagon in counter-clockwise order, without repetitions
+    int n=points.size();
+    // Directions in counter-clockwise order : E, NE, N, NW, W, SW, S, SE. The extreme point in a direction maximizes key
+    auto key = [](const basic_point<T>& p, int d){
+        switch (d)
+        {
+        case 0: return p.x;
+        case 1: return p.x+p.y;
+        case 2: return p.y;
+        case 3: return p.y-p.x;
+        case 4: return -p.x;
+        case 5: return -p.x-p.y;
+        case 6: return -p.y;
+        default: return p.x-p.y;
+        }
+    };
+    // Each thread looks for the extremes of its chunk, the calling one taking chunk 0, then the results
+    // are reduced
+    vector<array<int,8>> best(nb_threads);
+    auto scan = [&](int t){
+        int first=(long long)n*t/nb_threads, last=(long long)n*(t+1)/nb_threads;
+        array<T,8> best_key;
+        forn(d,8){
+            best[t][d]=first;
+            best_key[d]=key(points[first], d);
+        }
+        for (int i=first+1; i<last; i++){
+            forn(d,8){
+                T k=key(points[i], d);
+                bool better=k>best_key[d];
+                best_key[d]=better ? k : best_key[d];
+                best[t][d]=better ? i : best[t][d];
+            }
+        }
+    };
+    vector<thread> workers;
+    for (int t=1; t<nb_threads; t++) workers.emplace_back(scan, t);
+    scan(0);
+    for (auto& w : workers) w.join();
+    vector<basic_point<T>> octagon;
+    forn(d,8){
+        int arg=best[0][d];
+        for (int t=1; t<nb_threads; t++) if (key(points[best[t][d]], d)>key(points[arg], d)) arg=best[t][d];
+        if (octagon.empty() || !(octagon.back()==points[arg])) octagon.push_back(points[arg]);
+    }
+    while (octagon.size()>1 && octagon.back()==octagon.front()) octagon.pop_back();
+    return octagon;
+}
+
+template <typename T>
+size_t akl_toussaint_filter(vector<basic_point<T>>& points, int nb_threads=thread::hardware_concurrency()){
+    // Removes in place the points strictly inside the extreme octagon, keeping the order of the others.
+    // Returns the number of points discarded. The hull of what is left is the hull of the input.
+    STATS_TIMER(PHASE_PREFILTER);
+    int n=points.size();
+    nb_threads=max(1, min(nb_threads, n/PARALLEL_GRAIN));
+    if (n<=8) return 0;
+    vector<basic_point<T>> octagon=extreme_octagon(points, nb_threads);
+    int m=octagon.size();
+    if (m<3) return 0; // All the points are on a line, nothing is strictly inside
+    // The ends of edge e are octagon[e] and next[e], so that the inside test is a branch-free loop
+    vector<basic_point<T>> next(octagon.begin()+1, octagon.end());
+    next.push_back(octagon[0]);
+    // Only the points certainly inside are discarded : the filtered predicate is enough, a point too
+    // close to an edge for it is kept
+    auto compact = [&](int first, int last){
+        // Moves the points of [first, last) which are not strictly on the left of every edge to the
+        // front, block by block. Returns the end of the kept points.
+        int8_t inside[KERNEL_BLOCK], signs[KERNEL_BLOCK];
+        int write=first;
+        for (int i=first; i<last; i+=KERNEL_BLOCK){
+            int size=min(KERNEL_BLOCK, last-i);
+            fill(inside, inside+size, 1);
+            forn(e,m){
+                orient_batch(octagon[e], next[e], points.data()+i, size, signs);
+                forn(j,size) inside[j]&=(signs[j]>0);
+            }
+            forn(j,size) if (!inside[j]) points[write++]=points[i+j];
+        }
+        return write;
+    };
+    // Each thread compacts its own chunk, then the kept parts are moved next to each other
+    vector<int> bounds(nb_threads+1), ends(nb_threads);
+    forn(t,nb_threads+1) bounds[t]=(int)((long long)n*t/nb_threads);
+    vector<thread> workers;
+    for (int t=1; t<nb_threads; t++) workers.emplace_back([&, t](){
+        ends[t]=compact(bounds[t], bounds[t+1]);
+    });
+    ends[0]=compact(bounds[0], bounds[1]);
+    for (auto& w : workers) w.join();
+    auto write=points.begin()+ends[0];
+    for (int t=1; t<nb_threads; t++) write=move(points.begin()+bounds[t], points.begin()+ends[t], write);
+    size_t discarded=points.end()-write;
+    points.erase(write, points.end());
+    STATS_ADD(pruned, discarded);
+    return discarded;
+}
+
+/* Part 5 : Chan's algorithm */
+
+// Output-sensitive engine in O(n log h). The points are split into groups of m points, the hull of
+// each group (mini-hull) is computed, then the hull is wrapped around the groups like in Jarvis' march :
+// each wrapping step asks every mini-hull for its tangent in O(log m). If the wrapping needs more than m
+// steps, m was too small and is squared.
+// The points are sorted only once, by groups of CHAN_FIRST points. The mini-hulls of a round are merged
+// two by two, in linear time, into the ones of the next round : only their points are kept, the others
+// being inside the hull. Starting with m = 4 or 16 would cost more passes over all the points than it
+// could save on small hulls. The wrapping goes from vertex to vertex, skipping the points inside the
+// edges, which are then collected from the mini-hulls.
+
+const int CHAN_FIRST=256; // First value of m
+
+// Work buffers of unite_hulls
+template <typename T>
+struct hull_scratch{
+    vector<basic_point<T>> merged, upper, lower;
+};
+
+template <typename T>
+void unite_hulls(const basic_point<T>* a, int na, const basic_point<T>* b, int nb, vector<basic_point<T>>& res, hull_scratch<T>& scratch){
+    // Appends to 'res' the points of the hull of a and b (with the points inside its edges) in
+    // lexicographic order. a and b are sorted, and can be any points : hulls, or a group to start with.
+    const basic_point<T>* merged=a;
+    if (nb>0){
+        scratch.merged.resize(na+nb);
+        merge(a, a+na, b, b+nb, scratch.merged.begin(), point_cmp<T>);
+        merged=scratch.merged.data();
+    }
+    scratch.upper.clear();
+    scratch.lower.clear();
+    sweep_pass(merged, merged+na+nb, scratch.upper);
+    sweep_pass(make_reverse_iterator(merged+na+nb), make_reverse_iterator(merged), scratch.lower);
+    // Both chains are in order, the lower one backwards, and share their ends
+    set_union(all(scratch.upper), scratch.lower.rbegin(), scratch.lower.rend(), back_inserter(res), point_cmp<T>);
+}
+
+template <typename It, typename T>
+void strict_chain(It first, It last, vector<basic_point<T>>& chain){
+    // Appends to 'chain' the vertices of the chain of the sorted distinct points [first, last), like
+    // sweep_pass but without the points inside the edges
+    int start=chain.size();
+    for (It it=first; it!=last; ++it){
+        while ((int)chain.size()-start>=2 && orient_sign(chain[chain.size()-2], chain.back(), *it)>=0) chain.pop_back();
+        chain.push_back(*it);
+    }
+}
+
+template <typename T>
+int chain_tangent(const basic_point<T>* chain, int size, const basic_point<T>& p, bool increasing){
+    // 'chain' is the upper (increasing) or lower (decreasing) chain of a mini-hull, and 'p' a point of
+    // the hull. Returns the index of the vertex after 'p' which is the furthest counter-clockwise seen
+    // from 'p', the furthest from 'p' on a tie, or -1 if there is no vertex after 'p'.
+    auto not_after = [&](const basic_point<T>& q){ return increasing ? !point_cmp(p, q) : !point_cmp(q, p); };
+    int l=partition_point(chain, chain+size, not_after)-chain;
+    int r=size-1;
+    if (l>r) return -1;
+    // Along the chain, the vertices turn counter-clockwise seen from 'p' up to the tangent, then clockwise.
+    // The chain has no collinear vertices, so a tie only happens on an edge in line with 'p'.
+    while (l<r){
+        int mid=(l+r)/2;
+        if (orient_sign(p, chain[mid], chain[mid+1])>=0) l=mid+1;
+        else r=mid;
+    }
+    return l;
+}
+
+template <typename T>
+bool chan_wrap(const vector<basic_point<T>>& chains, const vector<int>& offsets, bool increasing, const basic_point<T>& last, int max_steps, vector<basic_point<T>>& hull){
+    // Wraps the hull from hull.back() to 'last' using the chains of the mini-hulls, chain g being
+    // chains[offsets[g]..offsets[g+1]). Returns false if it takes more than 'max_steps' steps.
+    for (int steps=0; !(hull.back()==last); steps++){
+        if (steps==max_steps) return false;
+        basic_point<T> p=hull.back();
+        int best=-1;
+        forn(g,(int)offsets.size()-1){
+            int i=chain_tangent(chains.data()+offsets[g], offsets[g+1]-offsets[g], p, increasing);
+            if (i<0) continue;
+            i+=offsets[g];
+            if (best<0){
+                best=i;
+                continue;
+            }
+            int turn=orient_sign(p, chains[best], chains[i]);
+            // On a tie, take the furthest point : the points inside the edge are added afterwards
+            if (turn>0 || (turn==0 && (increasing ? point_cmp(chains[best], chains[i]) : point_cmp(chains[i], chains[best]))))
+                best=i;
+        }
+        hull.push_back(chains[best]);
+    }
+    return true;
+}
+
+template <typename T>
+vector<basic_point<T>> convex_hull_chan(vector<basic_point<T>>& points){
+    // Same contract as convex_hull_sweeping : the points are reordered, and the hull is returned in
+    // the same order, starting from the leftmost point.
+    using P=basic_point<T>;
+    int n=points.size();
+    if (n<=2) return convex_hull_sweeping(points);
+    P first=*min_element(all(points), point_cmp<T>);
+    P last=*max_element(all(points), point_cmp<T>);
+    hull_scratch<T> scratch;
+    // The mini-hulls, one after the other : mini-hull g is hulls[offsets[g]..offsets[g+1])
+    vector<P> hulls, merged_hulls;
+    vector<int> offsets{ 0 }, merged_offsets;
+    // The points of a group strictly inside the quadrilateral of its extremes in x and y are not on its
+    // mini-hull, and are dropped before sorting when the filtered predicate is sure of it.
+    // A group is sorted by the radix keys of its points (see point_key) with the index of the point in the
+    // last byte : integers are sorted instead of points. The points are then gathered in that order, and
+    // an insertion sort fixes the order of the points whose truncated keys are equal.
+    static_assert(CHAN_FIRST<=256, "The index of a point in its group must fit in a byte");
+    vector<uint64_t> keys(CHAN_FIRST);
+    vector<P> group(CHAN_FIRST);
+    for (int g=0; g<n; g+=CHAN_FIRST){
+        int size=min(CHAN_FIRST, n-g);
+        const P* pts=points.data()+g;
+        int left=0, bottom=0, right=0, top=0;
+        for (int k=1; k<size; k++){
+            if (point_cmp(pts[k], pts[left])) left=k;
+            if (point_cmp(pts[right], pts[k])) right=k;
+            if (pts[k].y<pts[bottom].y) bottom=k;
+            if (pts[k].y>pts[top].y) top=k;
+        }
+        const P quad[5]={ pts[left], pts[bottom], pts[right], pts[top], pts[left] };
+        int kept=0;
+        forn(k,size){
+            bool inside=true;
+            forn(e,4) inside&=(orient_filtered(quad[e], quad[e+1], pts[k])>0);
+            if (!inside) keys[kept++]=(point_key(pts[k])&~0xFFULL)|k;
+        }
+        size=kept;
+        sort(keys.begin(), keys.begin()+size);
+        forn(k,size){
+            P p=pts[keys[k]&0xFF];
+            int j=k;
+            for (; j>0 && point_cmp(p, group[j-1]); j--) group[j]=group[j-1];
+            group[j]=p;
+        }
+        unite_hulls(group.data(), size, (P*)nullptr, 0, hulls, scratch);
+        offsets.push_back(hulls.size());
+    }
+    vector<P> chains_up, chains_down;
+    vector<int> offsets_up, offsets_down;
+    int nb_groups=offsets.size()-1;
+    long long group_size=CHAN_FIRST;
+    for (long long m=CHAN_FIRST;; m=m*m){
+        // Merges the mini-hulls two by two up to groups of m points, and further while a wrapping step,
+        // which asks every mini-hull, could cost more than merging all of them once more
+        for (; nb_groups>1 && (group_size<m || (long long)nb_groups*m>(long long)hulls.size()); group_size*=2){
+            merged_hulls.clear();
+            merged_offsets.assign(1, 0);
+            for (int g=0; g<nb_groups; g+=2){
+                const P* a=hulls.data()+offsets[g];
+                int na=offsets[g+1]-offsets[g];
+                int nb=(g+1<nb_groups ? offsets[g+2]-offsets[g+1] : 0);
+                unite_hulls(a, na, a+na, nb, merged_hulls, scratch);
+                merged_offsets.push_back(merged_hulls.size());
+            }
+            swap(hulls, merged_hulls);
+            swap(offsets, merged_offsets);
+            nb_groups=offsets.size()-1;
+        }
+        if (nb_groups==1){
+            // The only mini-hull is the hull
+            vector<P> hull_up, hull_down;
+            sweep_pass(all(hulls), hull_up);
+            sweep_pass(hulls.rbegin(), hulls.rend(), hull_down);
+            for (int j=1;j<(int)(hull_down.size())-1;j++) hull_up.push_back(hull_down[j]);
+            return hull_up;
+        }
+        chains_up.clear();
+        chains_down.clear();
+        offsets_up.assign(1, 0);
+        offsets_down.assign(1, 0);
+        forn(g,nb_groups){
+            strict_chain(hulls.begin()+offsets[g], hulls.begin()+offsets[g+1], chains_up);
+            offsets_up.push_back(chains_up.size());
+            strict_chain(hulls.rbegin()+(hulls.size()-offsets[g+1]), hulls.rbegin()+(hulls.size()-offsets[g]), chains_down);
+            offsets_down.push_back(chains_down.size());
+        }
+        vector<P> hull_up{ first }, hull_down{ last };
+        if (chan_wrap(chains_up, offsets_up, true, last, m, hull_up) && chan_wrap(chains_down, offsets_down, false, first, m, hull_down)){
+            // The points of the mini-hulls on the edges of the upper and lower chains, found by the
+            // position of each point among the vertices
+            vector<P> on_up, on_down;
+            auto on_edge=[](const vector<P>& chain, const P& q, auto&& before){
+                int i=upper_bound(all(chain), q, before)-chain.begin();
+                if (i>0 && chain[i-1]==q) return true;
+                return i>0 && i<(int)chain.size() && orient_sign(chain[i-1], chain[i], q)==0;
+            };
+            auto decreasing=[](const P& a, const P& b){ return point_cmp(b, a); };
+            for (const P& q : hulls){
+                if (on_edge(hull_up, q, point_cmp<T>)) on_up.push_back(q);
+                if (on_edge(hull_down, q, decreasing)) on_down.push_back(q);
+            }
+            sort(all(on_up), point_cmp<T>);
+            on_up.erase(unique(all(on_up)), on_up.end());
+            sort(all(on_down), decreasing);
+            on_down.erase(unique(all(on_down)), on_down.end());
+            for (int j=1;j<(int)(on_down.size())-1;j++) on_up.push_back(on_down[j]);
+            return on_up;
+        }
+    }
+}
+
+/* Part 6 : Dynamic hull */
+
+// Fully dynamic hull in the style of Overmars and van Leeuwen. The distinct points are the leaves of
+// a binary tree, in lexicographic order, and each internal node stores the bridge between the upper
+// hulls of its two children : the upper hull of a node is the one of its left child up to the
+// bridge, then the one of its right child from the bridge. An update recomputes the bridges on the
+// path to the root, each one in O(log n) by going down both children at the same time, so it takes
+// O(log^2 n). The tree is kept balanced by rebuilding the subtrees that get too unbalanced
+// (scapegoat rule), and the whole tree when a quarter of its points are gone.
+// Like the sweeping, the hulls keep their collinear points.
+
+template <typename T>
+class DynamicUpperHull {
+private:
+    using point = basic_point<T>;
+
+    struct Node {
+        point p; // The point of a leaf, a point between the two subtrees of an internal node
+        int left = -1, right = -1, parent = -1;
+        int size = 1; // Number of leaves of the subtree
+        int count = 1; // Number of copies of the point of a leaf
+        int a = -1, b = -1; // Leaves at the ends of the bridge of an internal node
+        bool dirty = false; // Bridge to recompute after a batch of erasures
+
+        Node(const point& p): p{ p } {}
+
+        bool isLeaf() const {
+            return left < 0;
+        }
+    };
+
+    static constexpr double ALPHA = 0.75; // No child can hold more than this share of the leaves
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    int root = -1;
+    int maxSize = 0; // Largest number of leaves since the last rebuild of the whole tree
+
+    // 'p' is taken by copy : it can be the point of a node, and 'nodes' can grow.
+    int newNode(point p) {
+        if (freeNodes.empty()) {
+            nodes.emplace_back(p);
+            return nodes.size() - 1;
+        }
+        int v = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[v] = Node(p);
+        return v;
+    }
+
+    // Replaces the child 'from' of 'parent' (the root if it is -1) by 'to'.
+    void replaceChild(int parent, int from, int to) {
+        nodes[to].parent = parent;
+        if (parent < 0)
+            root = to;
+        else if (nodes[parent].left == from)
+            nodes[parent].left = to;
+        else
+            nodes[parent].right = to;
+    }
+
+    // Finds the bridge of the internal node v. x and y go down the left and right children towards
+    // the ends t and s of the bridge, which is also the bridge between the subtrees of x and y. At
+    // each step, the bridges (a, b) of x and (c, d) of y, edges of their upper hulls, tell on which
+    // side of them t or s is.
+    void computeBridge(int v) {
+        int x = nodes[v].left, y = nodes[v].right;
+        const point& split = nodes[v].p;
+        while (!nodes[x].isLeaf() || !nodes[y].isLeaf()) {
+            const point& a = nodes[nodes[x].isLeaf() ? x : nodes[x].a].p;
+            const point& b = nodes[nodes[x].isLeaf() ? x : nodes[x].b].p;
+            const point& c = nodes[nodes[y].isLeaf() ? y : nodes[y].a].p;
+            const point& d = nodes[nodes[y].isLeaf() ? y : nodes[y].b].p;
+            if (nodes[x].isLeaf()) {
+                // s is after c iff t = a is strictly above the line (c, d)
+                y = orient_sign(c, d, a) > 0 ? nodes[y].right : nodes[y].left;
+            }
+            else if (nodes[y].isLeaf()) {
+                // t is before b iff s = c is strictly above the line (a, b)
+                x = orient_sign(a, b, c) > 0 ? nodes[x].left : nodes[x].right;
+            }
+            else if (orient_sign(a, b, c) > 0 || orient_sign(a, b, d) > 0) {
+                // A point of the right hull above the line (a, b) : the bridge is steeper than (a, b)
+                x = nodes[x].left;
+            }
+            else if (int cda = orient_sign(c, d, a); cda > 0 || orient_sign(c, d, b) > 0) {
+                // Same on the other side : the bridge is less steep than (c, d)
+                y = nodes[y].right;
+            }
+            else if (cda == 0 && orient_sign(a, b, d) == 0) {
+                // (a, b) and (c, d) are on the bridge line. The bridge is taken between its two
+                // innermost points so that the collinear points stay on the hull.
+                x = nodes[x].right;
+                y = nodes[y].left;
+            }
+            else {
+                // Either t is after a or s is before d. If t was before a, the lines (a, b) and
+                // (c, d) would cross after s, and so after the split. If s was after d, they would
+                // cross before t.
+                if (intersection_cmp(a, b, c, d, split) <= 0)
+                    x = nodes[x].right;
+                else
+                    y = nodes[y].left;
+            }
+        }
+        nodes[v].a = x;
+        nodes[v].b = y;
+    }
+
+    // Builds a balanced tree on the leaves [first, last), which are in order, and returns its root.
+    int build(const int* first, const int* last) {
+        if (last - first == 1)
+            return *first;
+        const int* middle = first + (last - first) / 2;
+        int left = build(first, middle), right = build(middle, last);
+        int v = newNode(nodes[*(middle - 1)].p);
+        nodes[v].left = left;
+        nodes[v].right = right;
+        nodes[left].parent = nodes[right].parent = v;
+        nodes[v].size = last - first;
+        computeBridge(v);
+        return v;
+    }
+
+    // Appends the leaves of the subtree of v to 'leaves', in order, and frees its internal nodes.
+    void collectLeaves(int v, std::vector<int>& leaves) {
+        if (nodes[v].isLeaf()) {
+            leaves.push_back(v);
+            return;
+        }
+        collectLeaves(nodes[v].left, leaves);
+        collectLeaves(nodes[v].right, leaves);
+        freeNodes.push_back(v);
+    }
+
+    // Rebuilds the subtree of v as a balanced tree. Returns its new root.
+    int rebuild(int v) {
+        int parent = nodes[v].parent;
+        std::vector<int> leaves;
+        leaves.reserve(nodes[v].size);
+        collectLeaves(v, leaves);
+        int u = build(leaves.data(), leaves.data() + leaves.size());
+        replaceChild(parent, v, u);
+        return u;
+    }
+
+    // Appends to 'res' the vertices of the upper hull of the subtree of v between 'lo' and 'hi'
+    // (no bound if nullptr).
+    void collectHull(int v, const point* lo, const point* hi, std::vector<point>& res) const {
+        if (nodes[v].isLeaf()) {
+            res.push_back(nodes[v].p);
+            return;
+        }
+        const point& a = nodes[nodes[v].a].p;
+        const point& b = nodes[nodes[v].b].p;
+        if (lo == nullptr || !(a < *lo))
+            collectHull(nodes[v].left, lo, hi != nullptr && *hi < a ? hi : &a, res);
+        if (hi == nullptr || !(*hi < b))
+            collectHull(nodes[v].right, lo != nullptr && b < *lo ? lo : &b, hi, res);
+    }
+
+    // Removes one copy of p. Returns false if there was none, else 'from' is the lowest node whose
+    // bridge must be recomputed, with all its ancestors (-1 if none).
+    bool detach(const point& p, int& from) {
+        from = -1;
+        if (root < 0)
+            return false;
+        int v = root;
+        while (!nodes[v].isLeaf())
+            v = nodes[v].p < p ? nodes[v].right : nodes[v].left;
+        if (!(nodes[v].p == p))
+            return false;
+        if (--nodes[v].count > 0)
+            return true;
+
+        // The parent of v is replaced by the sibling of v.
+        int parent = nodes[v].parent;
+        freeNodes.push_back(v);
+        if (parent < 0) {
+            root = -1;
+            return true;
+        }
+        int sibling = nodes[parent].left == v ? nodes[parent].right : nodes[parent].left;
+        int grandParent = nodes[parent].parent;
+        replaceChild(grandParent, parent, sibling);
+        freeNodes.push_back(parent);
+        for (int u = grandParent; u >= 0; u = nodes[u].parent)
+            nodes[u].size--;
+        from = grandParent;
+        return true;
+    }
+
+    // Recomputes the dirty bridges of the subtree of v, the children before their parent. The dirty
+    // nodes are the ancestors of the erased leaves, so they form a subtree at the root.
+    void refresh(int v) {
+        if (!nodes[v].dirty)
+            return;
+        nodes[v].dirty = false;
+        refresh(nodes[v].left);
+        refresh(nodes[v].right);
+        computeBridge(v);
+    }
+
+    // Rebuilds the whole tree once a quarter of its points are gone. Returns false if it was not needed.
+    bool shrink() {
+        if (root < 0 || size() >= ALPHA * maxSize)
+            return false;
+        rebuild(root);
+        maxSize = size();
+        return true;
+    }
+
+public:
+    DynamicUpperHull() = default;
+
+    // Tree of the points of 'sorted', distinct and in lexicographic order, built bottom-up.
+    explicit DynamicUpperHull(const std::vector<point>& sorted) {
+        nodes.reserve(2 * sorted.size());
+        std::vector<int> leaves;
+        leaves.reserve(sorted.size());
+        for (const point& p : sorted)
+            leaves.push_back(newNode(p));
+        if (!leaves.empty())
+            root = build(leaves.data(), leaves.data() + leaves.size());
+        maxSize = sorted.size();
+    }
+
+    // Number of distinct points.
+    int size() const {
+        return root < 0 ? 0 : nodes[root].size;
+    }
+
+    void insert(const point& p) {
+        if (root < 0) {
+            root = newNode(p);
+            maxSize = 1;
+            return;
+        }
+        int v = root;
+        while (!nodes[v].isLeaf())
+            v = nodes[v].p < p ? nodes[v].right : nodes[v].left;
+        if (nodes[v].p == p) {
+            nodes[v].count++;
+            return;
+        }
+
+        // The leaf v becomes an internal node with children v and p.
+        int leaf = newNode(p);
+        int inner = newNode(p < nodes[v].p ? p : nodes[v].p);
+        replaceChild(nodes[v].parent, v, inner);
+        nodes[inner].left = p < nodes[v].p ? leaf : v;
+        nodes[inner].right = p < nodes[v].p ? v : leaf;
+        nodes[leaf].parent = nodes[v].parent = inner;
+        nodes[inner].size = 2;
+        int scapegoat = -1;
+        for (int u = nodes[inner].parent; u >= 0; u = nodes[u].parent) {
+            nodes[u].size++;
+            if (max(nodes[nodes[u].left].size, nodes[nodes[u].right].size) > ALPHA * nodes[u].size)
+                scapegoat = u;
+        }
+        maxSize = max(maxSize, size());
+
+        int u = inner;
+        if (scapegoat >= 0)
+            u = rebuild(scapegoat);
+        else
+            computeBridge(u);
+        for (u = nodes[u].parent; u >= 0; u = nodes[u].parent)
+            computeBridge(u);
+    }
+
+    // Removes one copy of p. Returns false if there was none.
+    bool erase(const point& p) {
+        int from;
+        if (!detach(p, from))
+            return false;
+        if (!shrink())
+            for (int u = from; u >= 0; u = nodes[u].parent)
+                computeBridge(u);
+        return true;
+    }
+
+    // Removes one copy of each point of 'points' (if there is one). The paths of the erased leaves to
+    // the root share their upper nodes, whose bridges are recomputed only once for the whole batch.
+    void erase(const std::vector<point>& points) {
+        for (const point& p : points) {
+            int from;
+            detach(p, from);
+            for (int u = from; u >= 0 && !nodes[u].dirty; u = nodes[u].parent)
+                nodes[u].dirty = true;
+        }
+        if (!shrink() && root >= 0)
+            refresh(root);
+    }
+
+    // Vertices of the upper hull, from the smallest point to the largest one.
+    std::vector<point> upperHull() const {
+        std::vector<point> res;
+        if (root >= 0)
+            collectHull(root, nullptr, nullptr, res);
+        return res;
+    }
+};
+
+// Dynamic version of convex_hull_sweeping. The lower hull is the upper hull of the points rotated
+// by a half-turn, kept in a second tree.
+template <typename T>
+class DynamicHull {
+private:
+    using point = basic_point<T>;
+
+    DynamicUpperHull<T> upper, lower;
+
+    static point rotated(const point& p) {
+        return point(-p.x, -p.y);
+    }
+
+public:
+    DynamicHull() = default;
+
+    // Same as inserting the points one by one, for distinct points in lexicographic order, but in
+    // O(n log n) : the half-turn reverses the order, so the lower tree is built from the reversed points.
+    explicit DynamicHull(const std::vector<point>& sorted): upper{ sorted } {
+        std::vector<point> reversed;
+        reversed.reserve(sorted.size());
+        for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
+            reversed.push_back(rotated(*it));
+        lower = DynamicUpperHull<T>(reversed);
+    }
+
+    // Number of distinct points.
+    int size() const {
+        return upper.size();
+    }
+
+    void insert(const point& p) {
+        upper.insert(p);
+        lower.insert(rotated(p));
+    }
+
+    // Removes one copy of p. Returns false if there was none.
+    bool erase(const point& p) {
+        lower.erase(rotated(p));
+        return upper.erase(p);
+    }
+
+    // Removes one copy of each point of 'points', faster than one by one.
+    void erase(const std::vector<point>& points) {
+        std::vector<point> rotatedPoints;
+        rotatedPoints.reserve(points.size());
+        for (const point& p : points)
+            rotatedPoints.push_back(rotated(p));
+        upper.erase(points);
+        lower.erase(rotatedPoints);
+    }
+
+    // Same result as convex_hull_sweeping on the current points.
+    std::vector<point> hull() const {
+        std::vector<point> res{ upper.upperHull() };
+        std::vector<point> lowerHull{ lower.upperHull() };
+        // The lower hull goes from the largest point back to the smallest one, which are already in res
+        for (int j = 1; j < (int)lowerHull.size() - 1; j++)
+            res.push_back(rotated(lowerHull[j]));
+        return res;
+    }
+};
+
+/* Part 7 : Out-of-core hull */
+
+// Point files larger than memory are processed chunk by chunk. Each chunk is merged with the running
+// hull by the sweeping : a point dropped from the hull of a prefix of the file is strictly inside the
+// final hull, so the result is the same as convex_hull_sweeping on the whole file. At any time only
+// one chunk (two while the next one is being read) and the hull are in memory.
+
+// Number of points per chunk
+const size_t STREAM_CHUNK=1<<20;
+
+template <typename T>
+void stream_merge(vector<basic_point<T>>& hull, vector<basic_point<T>>& chunk){
+    // 'chunk' is reused by the caller for the next chunk, so its capacity stays chunk + hull
+    chunk.insert(chunk.end(), all(hull));
+    hull=convex_hull_sweeping(chunk);
+}
+
+template <typename T>
+vector<basic_point<T>> convex_hull_streaming(const char* filename, size_t chunk_size=STREAM_CHUNK, bool use_mmap=true){
+    using P = basic_point<T>;
+    fd_guard file(filename);
+    point_file_header header=read_header<T>(file.fd, filename);
+    size_t n=header.count;
+    size_t bytes=sizeof(header)+n*sizeof(P);
+    vector<P> hull, chunk;
+
+    // The file is mapped read-only here : the chunks are copied anyway to be merged with the hull
+    map_guard mapping((use_mmap && n>0) ? mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, file.fd, 0) : MAP_FAILED, bytes);
+    void* mapped=mapping.mapped;
+    if (mapped!=MAP_FAILED){
+        // The kernel reads the next chunk in the background (MADV_WILLNEED) while the current one is
+        // processed, and the pages of a chunk are released as soon as it has been copied
+        const P* points=(const P*)((char*)mapped+sizeof(header));
+        const size_t page=sysconf(_SC_PAGESIZE);
+        auto advise=[&](size_t first, size_t last, int advice){
+            size_t begin=(sizeof(header)+first*sizeof(P))/page*page;
+            madvise((char*)mapped+begin, sizeof(header)+last*sizeof(P)-begin, advice);
+        };
+        advise(0, n, MADV_SEQUENTIAL);
+        chunk.reserve(chunk_size);
+        for (size_t first=0; first<n; first+=chunk_size){
+            size_t last=min(n, first+chunk_size);
+            if (last<n) advise(last, min(n, last+chunk_size), MADV_WILLNEED);
+            chunk.assign(points+first, points+last);
+            advise(first, last, MADV_DONTNEED);
+            stream_merge(hull, chunk);
+        }
+    }
+    else {
+        // Not mappable (or mapping disabled) : a second thread reads the next chunk during the merge
+        auto read_chunk=[&](size_t first){
+            vector<P> buffer(min(chunk_size, n-first));
+            read_fully(file.fd, buffer.data(), buffer.size()*sizeof(P), sizeof(header)+first*sizeof(P), filename);
+            return buffer;
+        };
+        future<vector<P>> next;
+        try {
+            if (n>0) next=async(launch::async, read_chunk, 0);
+            for (size_t first=0; first<n; first+=chunk_size){
+                chunk=next.get();
+                if (first+chunk_size<n) next=async(launch::async, read_chunk, first+chunk_size);
+                stream_merge(hull, chunk);
+            }
+        }
+        catch (...){
+            // The pending read uses the file : it ends before the file is closed, its error if any is dropped
+            if (next.valid()) next.wait();
+            throw;
+        }
+    }
+    return hull;
+}
+
+/* Part 8 : Batched hulls */
+
+// Hulls of many small groups of points, given in CSR layout : group g is points[offsets[g], offsets[g+1]).
+// The hulls are written the same way into one buffer, hull g being hulls[hull_offsets[g], hull_offsets[g+1]),
+// each in the order of convex_hull_sweeping. The groups are split between threads by number of points,
+// and each thread reuses its scratch buffers from one group to the next.
+
+// Groups of at most this many points are sorted by insertion instead of std::sort
+const int SMALL_GROUP=16;
+
+template <typename T>
+void sort_small_group(vector<basic_point<T>>& points){
+    // On so few points the insertion sort beats std::sort and the sorting networks (measured
+    // with 4 to 16 points for the three scalar types)
+    for (int i=1; i<(int)points.size(); i++){
+        basic_point<T> p=points[i];
+        int j=i;
+        for (; j>0 && point_cmp(p, points[j-1]); j--) points[j]=points[j-1];
+        points[j]=p;
+    }
+}
+
+template <typename T>
+void convex_hull_batch(const vector<basic_point<T>>& points, const vector<size_t>& offsets,
+                       vector<basic_point<T>>& hulls, vector<size_t>& hull_offsets, int nb_threads=thread::hardware_concurrency()){
+    int nb_groups=max(0, (int)offsets.size()-1);
+    size_t n=nb_groups ? offsets[nb_groups]-offsets[0] : 0;
+    hull_offsets.assign(nb_groups+1, 0);
+
+    // Each thread gets a range of groups with about the same number of points, and appends their hulls
+    // to its own buffer. hull_offsets[g+1] first holds the size of hull g.
+    nb_threads=max(1, min(nb_threads, (int)(n/PARALLEL_GRAIN)));
+    vector<int> bounds(nb_threads+1);
+    bounds[nb_threads]=nb_groups;
+    for (int t=1; t<nb_threads; t++)
+        bounds[t]=upper_bound(offsets.begin(), offsets.begin()+nb_groups, offsets[0]+n*t/nb_threads)-offsets.begin()-1;
+    vector<vector<basic_point<T>>> outputs(nb_threads);
+
+    auto solve=[&](int t){
+        vector<basic_point<T>> scratch, hull_up, hull_down;
+        vector<basic_point<T>>& out=outputs[t];
+        for (int g=bounds[t]; g<bounds[t+1]; g++){
+            scratch.assign(points.begin()+offsets[g], points.begin()+offsets[g+1]);
+            if ((int)scratch.size()<=SMALL_GROUP) sort_small_group(scratch);
+            else sort(all(scratch), point_cmp<T>);
+            hull_up.clear();
+            hull_down.clear();
+            sweep_pass(scratch.begin(), scratch.end(), hull_up);
+            sweep_pass(scratch.rbegin(), scratch.rend(), hull_down);
+            size_t size=out.size();
+            out.insert(out.end(), all(hull_up));
+            if (hull_down.size()>2) out.insert(out.end(), hull_down.begin()+1, hull_down.end()-1);
+            hull_offsets[g+1]=out.size()-size;
+        }
+    };
+    vector<thread> workers;
+    for (int t=1; t<nb_threads; t++) workers.emplace_back(solve, t);
+    solve(0);
+    for (auto& w : workers) w.join();
+
+    forn(g,nb_groups) hull_offsets[g+1]+=hull_offsets[g];
+    hulls.resize(hull_offsets[nb_groups], basic_point<T>(0, 0));
+    workers.clear();
+    auto pack=[&](int t){
+        copy(all(outputs[t]), hulls.begin()+hull_offsets[bounds[t]]);
+        vector<basic_point<T>>().swap(outputs[t]);
+    };
+    for (int t=1; t<nb_threads; t++) workers.emplace_back(pack, t);
+    pack(0);
+    for (auto& w : workers) w.join();
+}
+
+/* Part 9 : Quickhull */
+
+// Divide and conquer without sort nor median. The points to the left of an edge (a, b) of the hull are
+// partitioned in place around the farthest one c, which is on the hull : the points to the left of
+// (a, c), the points to the left of (c, b), and the points of the triangle (a, c, b), which are dropped.
+// The two outer sets are solved as tasks of a ThreadPool. Each call writes its chain at the beginning
+// of its own range, so the hull ends up at the beginning of the input, in the order of the sweeping.
+
+template <typename T>
+int farther_exact(const basic_point<T>& a, const basic_point<T>& b, const basic_point<T>& p, const basic_point<T>& q){
+    // Sign of cross(b-a, p-q) = b.x*p.y - b.x*q.y - a.x*p.y + a.x*q.y - b.y*p.x + b.y*q.x + a.y*p.x - a.y*q.x,
+    // computed exactly as in orient_exact : 1 if p is farther to the left of (a, b) than q
+    using wide=wide_scalar<T>;
+    const wide terms[8][2]={{b.x, p.y}, {-b.x, q.y}, {-a.x, p.y}, {a.x, q.y}, {-b.y, p.x}, {b.y, q.x}, {a.y, p.x}, {-a.y, q.x}};
+    array<wide,16> expansion;
+    int size=0;
+    for (const auto& term : terms){
+        wide products[2];
+        two_product(term[0], term[1], products[0], products[1]);
+        for (wide r : products){
+            forn(i,size) two_sum(r, expansion[i], r, expansion[i]);
+            expansion[size++]=r;
+        }
+    }
+    for (int i=size-1; i>=0; i--){
+        if (expansion[i]>0) return 1;
+        if (expansion[i]<0) return -1;
+    }
+    return 0;
+}
+
+template <typename T>
+basic_point<T>* farthest_point(const basic_point<T>& a, const basic_point<T>& b, basic_point<T>* first, basic_point<T>* last){
+    // The point of [first, last) the farthest strictly to the left of (a, b), or nullptr if there is none.
+    // The distances are estimated in double as in orient_filtered, and only compared exactly when their
+    // error bounds overlap (the margin of the bounds covers the rounding of the difference). Integer
+    // distances are exact.
+    if constexpr (is_integral_v<T>){
+        basic_point<T>* best=nullptr;
+        __int128 best_dist=0;
+        for (basic_point<T>* p=first; p!=last; ++p){
+            __int128 dist=cross_integer(a, b, *p);
+            if (dist>best_dist){
+                best=p;
+                best_dist=dist;
+            }
+        }
+        return best;
+    }
+    else {
+        using wide=wide_scalar<T>;
+        const double u=numeric_limits<double>::epsilon()/2;
+        double abx=(wide)b.x-(wide)a.x, aby=(wide)b.y-(wide)a.y;
+        basic_point<T>* best=nullptr;
+        double best_dist=0, best_error=0;
+        for (basic_point<T>* p=first; p!=last; ++p){
+            double apx=(wide)p->x-(wide)a.x, apy=(wide)p->y-(wide)a.y;
+            double left=abx*apy, right=aby*apx;
+            double dist=left-right;
+            double error=5*u*(fabs(left)+fabs(right));
+            if (dist<=error && orient_sign(a, b, *p)<=0) continue; // Not strictly to the left
+            if (!best || dist-best_dist>error+best_error){
+                best=p;
+                best_dist=dist;
+                best_error=error;
+            }
+            else if (dist-best_dist>=-(error+best_error) && !(*p==*best)){
+                orient_fallbacks.fetch_add(1, memory_order_relaxed);
+                if (farther_exact(a, b, *p, *best)>0){
+                    best=p;
+                    best_dist=dist;
+                    best_error=error;
+                }
+            }
+        }
+        return best;
+    }
+}
 
-ld random_double(){
-    // Generates a random ld by taking rng() (a 32 bits random integer generator), and dividing it by its maximum value (INT_MAX)
-    return ((ld)(rng())/((ld)(UINT32_MAX)));
+template <typename T>
+int sort_along(const basic_point<T>& a, const basic_point<T>& b, basic_point<T>* first, basic_point<T>* last){
+    // Sorts points of the segment (a, b) from a to b and removes the repeated ones. Returns how many are left.
+    if (point_cmp(a, b)) sort(first, last, point_cmp<T>);
+    else sort(first, last, [](const basic_point<T>& p, const basic_point<T>& q){ return point_cmp(q, p); });
+    return unique(first, last)-first;
 }
 
-vector<point> genA(int n){
-    // Generates n-4 points randomly in the [0,1]^2 square, and adds the corners. Applies a random rotation and a random shuffling
-    // The resulting points can be outside of [0,1]^2 but it doesn't matter. The center of rotation is chosen randomly in [0,1]^2
-    // If n<4, this function returns an error 
-    assert(n>=4 && "There are less than 4 points given to genA !");
+template <typename T>
+int quickhull_chain(const basic_point<T>& a, const basic_point<T>& b, basic_point<T>* first, basic_point<T>* last, ThreadPool& pool, int grain){
+    // [first, last) holds points strictly to the left of the edge (a, b) of the hull, and points of the
+    // open segment (a, b). Writes the vertices of the hull strictly between a and b, in clockwise order,
+    // at the beginning of the range and returns their number.
+    if (first==last) return 0;
+    basic_point<T>* farthest=farthest_point(a, b, first, last);
+    if (!farthest){
+        // Only points of the segment, which is an edge of the hull : they all are on the hull
+        return sort_along(a, b, first, last);
+    }
+    basic_point<T> c=*farthest;
+    // [left of (a, c) | left of (c, b) | dropped]. The points of the open segments (a, c) and (c, b) are
+    // kept, those of (a, b) are now strictly inside the hull.
+    basic_point<T>* mid;
+    basic_point<T>* end;
+    {
+        STATS_TIMER(PHASE_PARTITION);
+        mid=partition(first, last, [&](const basic_point<T>& p){ return !(p==c) && orient_sign(a, c, p)>=0; });
+        end=partition(mid, last, [&](const basic_point<T>& p){ return !(p==c) && orient_sign(c, b, p)>=0; });
+    }
+    int left, right;
+    if (min(mid-first, end-mid)>=grain){
+        ThreadPool::TaskGroup group;
+        pool.spawn(group, [&](){ left=quickhull_chain(a, c, first, mid, pool, grain); });
+        right=quickhull_chain(c, b, mid, end, pool, grain);
+        pool.wait(group);
+    }
+    else{
+        left=quickhull_chain(a, c, first, mid, pool, grain);
+        right=quickhull_chain(c, b, mid, end, pool, grain);
+    }
+    // Chain (a, c), then c, then chain (c, b). c is among the dropped points, so end < last and the
+    // chain (c, b) moves by at most one slot to the right.
+    basic_point<T>* dest=first+left+1;
+    if (dest<=mid) move(mid, mid+right, dest);
+    else move_backward(mid, mid+right, dest+right);
+    first[left]=c;
+    return left+1+right;
+}
 
-    vector<point> points; 
-    point rotation_center={random_double(), random_double()};
-    ld rotation_angle=random_double()*2.*M_PI;
+template <typename T>
+vector<basic_point<T>> convex_hull_quickhull(vector<basic_point<T>>& points, int nb_threads=thread::hardware_concurrency(), int grain=PARALLEL_GRAIN){
+    // Same contract as convex_hull_sweeping : the points are reordered, and the hull is returned in the
+    // same order, starting from the leftmost point and keeping the points of the edges.
+    int n=points.size();
+    if (n==0) return {};
+    auto [lo, hi]=extreme_points(points.data(), n);
+    basic_point<T> a=points[lo], b=points[hi];
+    if (a==b) return { a };
+    nb_threads=max(1, min(nb_threads, n/grain));
 
-    // Define a lambda-function for the rotation (even though there is probably one somewhere in the stl)
-    auto rotate = [&](point pt){
-        point centerToPt={pt.x-rotation_center.x, pt.y-rotation_center.y}; // Take the vector from center to target point
-        ld c=cos(rotation_angle);
-        ld s=sin(rotation_angle);
-        point rotated={centerToPt.x*c-centerToPt.y*s, centerToPt.x*s+centerToPt.y*c}; //Apply the well-known rotation matrix Rtheta
-        rotated.x+=rotation_center.x; rotated.y+=rotation_center.y;
-        return rotated;
-    };
-    forn(i,n-4){
-        point cur_point={random_double(), random_double()};
-        points.push_back(rotate(cur_point));
+    // [upper | lower | segment (a, b) | copies of a and b]
+    basic_point<T>* first=points.data();
+    basic_point<T>* last=first+n;
+    basic_point<T>* upper_end;
+    basic_point<T>* lower_end;
+    basic_point<T>* segment_end;
+    {
+        STATS_TIMER(PHASE_PARTITION);
+        upper_end=partition(first, last, [&](const basic_point<T>& p){ return orient_sign(a, b, p)>0; });
+        lower_end=partition(upper_end, last, [&](const basic_point<T>& p){ return orient_sign(a, b, p)<0; });
+        segment_end=partition(lower_end, last, [&](const basic_point<T>& p){ return !(p==a) && !(p==b); });
     }
-    vector<point> corners;
-    corners.push_back({0.,0.});
-    corners.push_back({1.,0.});
-    corners.push_back({0.,1.});
-    corners.push_back({1.,1.});
-    for (auto corner : corners){
-        points.push_back(rotate(corner));
+    int upper, lower;
+    {
+        ThreadPool pool(nb_threads);
+        ThreadPool::TaskGroup group;
+        pool.spawn(group, [&](){ lower=quickhull_chain(b, a, upper_end, lower_end, pool, grain); });
+        upper=quickhull_chain(a, b, first, upper_end, pool, grain);
+        pool.wait(group);
     }
+    // The points of the segment (a, b) are on the hull only if one side is empty
+    int segment=0;
+    if (upper==0 || lower==0) segment=sort_along(a, b, lower_end, segment_end);
+    vector<basic_point<T>> hull;
+    hull.reserve(upper+lower+2*segment+2);
+    hull.push_back(a);
+    if (upper>0) hull.insert(hull.end(), first, first+upper);
+    else hull.insert(hull.end(), lower_end, lower_end+segment);
+    hull.push_back(b);
+    if (lower>0) hull.insert(hull.end(), upper_end, upper_end+lower);
+    else hull.insert(hull.end(), make_reverse_iterator(lower_end+segment), make_reverse_iterator(lower_end));
+    return hull;
+}
 
-    shuffle(all(points), rng); // STL function to shuffle (I could do it myself by just n random positions)
+/* Part 10 : Hull queries */
 
-    freopen("datasetA.txt","w", stdout);
-    for (auto pt : points) cout<<fixed<<setprecision(PRECISION)<<pt.x<<" "<<pt.y<<"\n";
-    return points;
-}
+// Index over a hull in the order of convex_hull_sweeping, for many queries on the same hull. The hull
+// is split into its upper and lower chains, both in increasing lexicographic order, and a query is a
+// binary search on one or both chains : O(log h). The batch queries are split between threads, by
+// blocks of KERNEL_BLOCK queries whose binary searches run in lockstep. The rotating calipers
+// (diameter, width, minimum-area rectangle) walk the vertices of the hull in O(h).
 
-vector<point> genB(int n){
-    freopen("datasetB.txt","w", stdout);
-    vector<point> points;
-    forn(i,n){
-        ld x=random_double();
-        ld y=random_double();
-        points.push_back({x,y});
-        cout<<fixed<<setprecision(PRECISION)<<x<<" "<<y<<"\n"; 
+template <typename T>
+class HullIndex {
+private:
+    using point = basic_point<T>;
+    using real_point = basic_point<ld>;
+
+    std::vector<point> hull;       // As given : clockwise, from the leftmost point
+    std::vector<point> upperChain; // hull[0..k], hull[k] being the rightmost point
+    std::vector<point> lowerChain; // hull[0], then hull[n-1] down to hull[k]
+    std::vector<point> vertices;   // The hull without the points inside its edges
+    // Radix keys of the chains (see point_key) : the searches compare integers, and the points only
+    // where the keys are equal
+    std::vector<uint64_t> upperKeys, lowerKeys;
+    T minX{}, maxX{}, minY{}, maxY{};
+
+    // For each query k < count, the number of leading indices i of [0, size) for which pred(k, i) holds,
+    // pred(k, .) being true then false. The steps of the search only depend on 'size', so the searches
+    // of a block run in lockstep and without branches.
+    template <typename Pred>
+    static void countLeading(int size, int count, int* res, Pred&& pred) {
+        std::fill(res, res + count, 0);
+        if (size == 0)
+            return;
+        for (int len = size; len > 1; len -= len / 2) {
+            int half = len / 2;
+            for (int k = 0; k < count; ++k)
+                res[k] += pred(k, res[k] + half - 1) ? half : 0;
+        }
+        for (int k = 0; k < count; ++k)
+            res[k] += pred(k, res[k]) ? 1 : 0;
     }
-    return points;
-}
 
-vector<point> genC(int n){
-    // Using reject-accept algorithm in a circle
-    freopen("datasetC.txt","w", stdout);
-    vector<point> points;
-    while((int) points.size()<n){
-        ld x=random_double();
-        ld y=random_double();
-        double d = hypot(x-0.5, y-0.5);
-        if (d <=0.5){
-           // cout<<d<<"\n";
-            points.push_back({x,y});
-            cout<<fixed<<setprecision(PRECISION)<<x<<" "<<y<<"\n"; 
+    // Sign of dot(b - a, d), exact on integers.
+    static int dotSign(const point& a, const point& b, const point& d) {
+        if constexpr (std::is_integral_v<T>) {
+            __int128 dot = (__int128)((int64_t)b.x - a.x) * d.x + (__int128)((int64_t)b.y - a.y) * d.y;
+            return (dot > 0) - (dot < 0);
+        }
+        else {
+            ld dot = ((ld)b.x - a.x) * d.x + ((ld)b.y - a.y) * d.y;
+            return (dot > 0) - (dot < 0);
         }
     }
-    return points;
-}
 
-vector<point> genD(int n){
-    freopen("datasetD.txt","w", stdout);
-    vector<point> points;
-    forn(i,n){
-        ld theta=2.*M_PI*random_double();
-        ld x = 0.5*cos(theta)+0.5;
-        ld y = 0.5*sin(theta)+0.5;
-        cout<<fixed<<setprecision(PRECISION)<<x<<" "<<y<<"\n"; 
-        points.push_back({x,y});
+    // inside[k] = 1 if queries[k] is inside the hull or on its boundary, for count <= KERNEL_BLOCK.
+    void containsBlock(const point* queries, int count, uint8_t* inside) const {
+        // Most of the outside queries are rejected by the bounding box and by the ends of the chains
+        int candidates[KERNEL_BLOCK], nbCandidates = 0;
+        for (int k = 0; k < count; ++k) {
+            const point& q = queries[k];
+            bool in = !hull.empty() && q.x >= minX && q.x <= maxX && q.y >= minY && q.y <= maxY
+                && !(q < upperChain.front()) && !(upperChain.back() < q);
+            inside[k] = in;
+            candidates[nbCandidates] = k;
+            nbCandidates += in;
+        }
+        if (upperChain.size() < 2)
+            return;
+        int upper[KERNEL_BLOCK], lower[KERNEL_BLOCK];
+        uint64_t keys[KERNEL_BLOCK];
+        auto query = [&](int k) -> const point& { return queries[candidates[k]]; };
+        for (int k = 0; k < nbCandidates; ++k)
+            keys[k] = point_key(query(k));
+        // Number of points of the chain before the query : smaller key, or same key and not after it
+        auto search = [&](const std::vector<point>& chain, const std::vector<uint64_t>& chainKeys, int* res) {
+            countLeading(chain.size(), nbCandidates, res, [&](int k, int i) { return chainKeys[i] < keys[k]; });
+            for (int k = 0; k < nbCandidates; ++k)
+                while (res[k] < (int)chain.size() && chainKeys[res[k]] == keys[k] && !(query(k) < chain[res[k]]))
+                    ++res[k];
+        };
+        search(upperChain, upperKeys, upper);
+        search(lowerChain, lowerKeys, lower);
+        // Below the edge of the upper chain and above the edge of the lower chain over the query
+        for (int k = 0; k < nbCandidates; ++k) {
+            int i = std::min(upper[k], (int)upperChain.size() - 1) - 1;
+            int j = std::min(lower[k], (int)lowerChain.size() - 1) - 1;
+            inside[candidates[k]] = orient_sign(upperChain[i], upperChain[i + 1], query(k)) <= 0
+                && orient_sign(lowerChain[j], lowerChain[j + 1], query(k)) >= 0;
+        }
     }
-    return points;
-}
 
-/* Part 3 : Sweeping */
+    // indices[k] = index in the hull of a point maximizing dot(p, directions[k]), for count <= KERNEL_BLOCK.
+    void extremeBlock(const point* directions, int count, int* indices) const {
+        int n = hull.size();
+        if (n == 0) {
+            std::fill(indices, indices + count, -1);
+            return;
+        }
+        // Along a chain, the dot product with a direction increases then decreases. The upper chain
+        // holds the extreme points of the directions pointing up, the lower chain the others.
+        int onUpper[KERNEL_BLOCK], onLower[KERNEL_BLOCK], nbUpper = 0, nbLower = 0;
+        for (int k = 0; k < count; ++k) {
+            const point& d = directions[k];
+            if (d.y > 0 || (d.y == 0 && d.x < 0))
+                onUpper[nbUpper++] = k;
+            else
+                onLower[nbLower++] = k;
+        }
+        int res[KERNEL_BLOCK];
+        countLeading(upperChain.size() - 1, nbUpper, res, [&](int k, int i) {
+            return dotSign(upperChain[i], upperChain[i + 1], directions[onUpper[k]]) > 0;
+        });
+        for (int k = 0; k < nbUpper; ++k)
+            indices[onUpper[k]] = res[k];
+        countLeading(lowerChain.size() - 1, nbLower, res, [&](int k, int i) {
+            return dotSign(lowerChain[i], lowerChain[i + 1], directions[onLower[k]]) > 0;
+        });
+        for (int k = 0; k < nbLower; ++k)
+            indices[onLower[k]] = (n - res[k]) % n;
+    }
 
-ld cross(point a, point b){return a.x*b.y-a.y*b.x;}
+    // Runs block(first, count) on blocks of KERNEL_BLOCK queries of [0, n), split between threads.
+    template <typename F>
+    static void forBlocks(int n, int nbThreads, F&& block) {
+        nbThreads = std::max(1, std::min(nbThreads, n / PARALLEL_GRAIN));
+        auto run = [&](int t) {
+            int first = (long long)n * t / nbThreads, last = (long long)n * (t + 1) / nbThreads;
+            for (int i = first; i < last; i += KERNEL_BLOCK)
+                block(i, std::min(KERNEL_BLOCK, last - i));
+        };
+        std::vector<std::thread> workers;
+        for (int t = 1; t < nbThreads; ++t)
+            workers.emplace_back(run, t);
+        run(0);
+        for (auto& w : workers)
+            w.join();
+    }
 
-bool orient(point a, point b, point c){
-    // Returns 1 if clockwise and 0 if counter-clockwise.
-    // Stems from a x b = ||a|| ||b|| sin(theta) where x is cross product
-    point a_to_b={b.x-a.x, b.y-a.y};
-    point a_to_c={c.x-a.x, c.y-a.y};
-    return (cross(a_to_b, a_to_c)<=0); //Negative means theta is negative means angle is clockwise 
-}
+    const point& vertex(int i) const {
+        return vertices[i % vertices.size()];
+    }
 
-vector<point> convex_hull_sweeping(vector<point>& points){
-    sort(all(points), [](const point a, const point b){
-        if (a.x==b.x) return a.y<b.y;
-        return a.x<b.x;
-    }); // Sort points by increasing x using a lambda function
-    int n=points.size();
-    vector<point> hull_up;
-    vector<point> hull_down;
-    // Increasing x pass
-    forn(i,n){
-        if(hull_up.size()<=1){ // If there are 0 or 1 points in the hull
-            hull_up.push_back(points[i]);
-        }
-        else{
-            // Compare orientation with the two previous points
-            point a=hull_up[hull_up.size()-2];
-            point b=hull_up[hull_up.size()-1];
-            point c=points[i];
-            if (orient(a,b,c)){
-                // If clockwise, meaning c is to the right side of b
-                hull_up.push_back(c);
-            }
-            else{
-                while(!orient(a,b,c) && (int)(hull_up.size())>=3){
-                    hull_up.pop_back(); // Remove the last point of the hull
-                    b=hull_up[hull_up.size()-1];
-                    a=hull_up[hull_up.size()-2];
-                }
-                if (!orient(a,b,c)){
-                    hull_up.pop_back();
-                }
-                hull_up.push_back(c);
-            }
+    static real_point lift(const point& p) {
+        return real_point(p.x, p.y);
+    }
+
+    // Twice the area of the triangle (a, b, p)
+    static ld area(const point& a, const point& b, const point& p) {
+        return fabsl(cross(lift(b) - lift(a), lift(p) - lift(a)));
+    }
+
+    static ld dot(const real_point& u, const real_point& v) {
+        return u.x * v.x + u.y * v.y;
+    }
+
+    // Calls visit(i, j) for every edge (i, i+1) of the vertices and the vertex j the farthest from it.
+    template <typename F>
+    void calipers(F&& visit) const {
+        int h = vertices.size();
+        int j = 1;
+        for (int i = 0; i < h; ++i) {
+            const point& a = vertex(i);
+            const point& b = vertex(i + 1);
+            while (area(a, b, vertex(j + 1)) > area(a, b, vertex(j)))
+                ++j;
+            visit(i, j);
         }
     }
-    // Decreasing x pass. If everything went well the rightmost point and leftmost point are in the hull so it's no use to consider them
-    for(int i=n-1;i>=0;i--){ 
-        if(hull_down.size()<=1){
-            hull_down.push_back(points[i]);
-        }
-        else{
-            point a=hull_down[hull_down.size()-2];
-            point b=hull_down[hull_down.size()-1];
-            point c=points[i];
-            if (orient(a,b,c)){
-                hull_down.push_back(c);
-            }
-            else{
-                while(!orient(a,b,c) && (int)(hull_down.size())>=3){
-                    hull_down.pop_back(); 
-                    b=hull_down[hull_down.size()-1];
-                    a=hull_down[hull_down.size()-2];
-                }
-                if (!orient(a,b,c)){
-                    hull_down.pop_back();
-                }
-                hull_down.push_back(c);
-            }
+
+public:
+    struct Segment {
+        point a, b;
+        ld length;
+    };
+
+    struct Rectangle {
+        std::array<real_point, 4> corners; // In order around the rectangle
+        ld area;
+    };
+
+    explicit HullIndex(std::vector<point> points) : hull{ std::move(points) } {
+        int n = hull.size();
+        if (n == 0)
+            return;
+        int k = std::max_element(hull.begin(), hull.end()) - hull.begin();
+        upperChain.assign(hull.begin(), hull.begin() + k + 1);
+        lowerChain.push_back(hull[0]);
+        for (int j = n - 1; k > 0 && j >= k; --j)
+            lowerChain.push_back(hull[j]);
+        for (const auto& p : upperChain)
+            upperKeys.push_back(point_key(p));
+        for (const auto& p : lowerChain)
+            lowerKeys.push_back(point_key(p));
+        minX = maxX = hull[0].x;
+        minY = maxY = hull[0].y;
+        for (const auto& p : hull) {
+            minX = std::min(minX, p.x);
+            maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y);
+            maxY = std::max(maxY, p.y);
         }
+        // The leftmost point is a vertex. A collinear hull only has its two ends as vertices.
+        if (std::all_of(hull.begin(), hull.end(), [&](const point& p) { return orient_sign(hull[0], hull[k], p) == 0; })) {
+            vertices.push_back(hull[0]);
+            if (k > 0)
+                vertices.push_back(hull[k]);
+            return;
+        }
+        for (const auto& p : hull) {
+            while (vertices.size() >= 2 && orient_sign(vertices[vertices.size() - 2], vertices.back(), p) == 0)
+                vertices.pop_back();
+            vertices.push_back(p);
+        }
+        while (orient_sign(vertices[vertices.size() - 2], vertices.back(), vertices[0]) == 0)
+            vertices.pop_back();
     }
-    for (int j=1;j<(int)(hull_down.size())-1;j++) hull_up.push_back(hull_down[j]);
-    return hull_up;
-}
 
-template <typename T>
-class MedianList {
-private:
-    using list_t = std::vector<T>;
+    const std::vector<point>& points() const {
+        return hull;
+    }
 
-    // Partitions 'lst' into two lists according to the 'pivot'.
-    static std::pair<list_t, list_t> partition(list_t lst, T pivot) {
-        list_t p1, p2;
-        for (auto x : lst)
-            (x < pivot ? p1 : p2).push_back(x);
-        
-        return std::pair(p1, p2);
+    // True if q is inside the hull or on its boundary.
+    bool contains(const point& q) const {
+        uint8_t inside;
+        containsBlock(&q, 1, &inside);
+        return inside;
     }
 
-    static T quickSelect(list_t lst, int k) {
-        if (lst.size() <= 5) {
-            sort(lst.begin(), lst.end());
-            return lst[k - 1];
-        }
-        list_t p1, p2;
-        T pivot = findMedianOfMedians(lst);
-        tie(p1, p2) = partition(lst, pivot);
-        if ((int)p1.size() >= k)
-            return quickSelect(p1, k);
-        else if (k > (int)(lst.size() - p2.size()))
-            return quickSelect(p2, k - (lst.size() - p2.size()));
+    std::vector<uint8_t> contains(const std::vector<point>& queries, int nbThreads = std::thread::hardware_concurrency()) const {
+        std::vector<uint8_t> inside(queries.size());
+        forBlocks(queries.size(), nbThreads, [&](int first, int count) { containsBlock(queries.data() + first, count, inside.data() + first); });
+        return inside;
+    }
 
-        return pivot;
+    // Index in points() of a point maximizing dot(p, d), -1 if the hull is empty. The dot products are
+    // exact on integers, and rounded to long double otherwise.
+    int extreme(const point& d) const {
+        int index;
+        extremeBlock(&d, 1, &index);
+        return index;
     }
 
-    static T findMedianNaive(list_t lst) {
-        list_t tmp{ lst };
-        std::sort(tmp.begin(), tmp.end());
+    std::vector<int> extreme(const std::vector<point>& directions, int nbThreads = std::thread::hardware_concurrency()) const {
+        std::vector<int> indices(directions.size());
+        forBlocks(directions.size(), nbThreads, [&](int first, int count) { extremeBlock(directions.data() + first, count, indices.data() + first); });
+        return indices;
+    }
 
-        return tmp[tmp.size() / 2];
+    // Farthest pair of points of the hull.
+    Segment diameter() const {
+        int h = vertices.size();
+        if (h == 0)
+            return { point{}, point{}, 0 };
+        Segment best{ vertices[0], vertices[h - 1], 0 };
+        ld best2 = -1;
+        auto consider = [&](const point& a, const point& b) {
+            real_point d = lift(b) - lift(a);
+            if (dot(d, d) > best2) {
+                best2 = dot(d, d);
+                best = { a, b, 0 };
+            }
+        };
+        consider(vertices[0], vertices[h - 1]);
+        if (h > 2)
+            calipers([&](int i, int j) {
+                consider(vertex(i), vertex(j));
+                consider(vertex(i + 1), vertex(j));
+            });
+        best.length = sqrtl(best2);
+        return best;
     }
-    
-    static T findMedianOfMedians(list_t lst) {
-        if ((int)lst.size() <= 5)
-            return findMedianNaive(lst);
-        list_t nxt;
-        for (int i = 0; i < (int)lst.size(); i += 5) {
-            list_t cur;
-            for (int j = i; j < min(i + 5, static_cast<int>(lst.size())); ++j)
-                cur.push_back(lst[j]);
-            nxt.push_back(findMedianNaive(cur));
-        }
-        
-        return findMedianOfMedians(nxt);
+
+    // Smallest distance between two parallel lines enclosing the hull.
+    ld width() const {
+        if (vertices.size() <= 2)
+            return 0;
+        ld best = std::numeric_limits<ld>::infinity();
+        calipers([&](int i, int j) {
+            real_point e = lift(vertex(i + 1)) - lift(vertex(i));
+            best = std::min(best, area(vertex(i), vertex(i + 1), vertex(j)) / sqrtl(dot(e, e)));
+        });
+        return best;
     }
 
-public:
-    // Note: this function is made to return a value below the median if the
-    // list has an odd number of elements. This is intentional and is used in
-    // the convex hull algorithm.
-    static T findMedian(list_t lst) {
-        T m1{ quickSelect(lst, lst.size() / 2) };
-        T m2{ quickSelect(lst, lst.size() / 2 + 1) };
-        return (m1 + m2) / 2;
+    // Rectangle of minimum area enclosing the hull. One of its sides is on an edge of the hull, so the
+    // calipers try each edge, with the vertices of largest and smallest projection on the edge.
+    Rectangle minAreaRectangle() const {
+        int h = vertices.size();
+        if (h <= 2) {
+            real_point a = h ? lift(vertices[0]) : real_point{}, b = h ? lift(vertices[h - 1]) : real_point{};
+            return { { a, b, b, a }, 0 };
+        }
+        Rectangle best{ {}, std::numeric_limits<ld>::infinity() };
+        int r = 0, j = 0, l = 0;
+        for (int i = 0; i < h; ++i) {
+            real_point a = lift(vertex(i));
+            real_point e = lift(vertex(i + 1)) - a;
+            auto step = [&](int k) { return dot(lift(vertex(k + 1)) - lift(vertex(k)), e); };
+            for (r = std::max(r, i); step(r) > 0; ++r) {}
+            for (j = std::max(j, r); area(vertex(i), vertex(i + 1), vertex(j + 1)) > area(vertex(i), vertex(i + 1), vertex(j)); ++j) {}
+            for (l = std::max(l, j); step(l) < 0; ++l) {}
+            ld length2 = dot(e, e);
+            ld hi = dot(lift(vertex(r)) - a, e) / length2, lo = dot(lift(vertex(l)) - a, e) / length2;
+            ld height = cross(e, lift(vertex(j)) - a) / length2;
+            ld rectangleArea = (hi - lo) * fabsl(height) * length2;
+            if (rectangleArea < best.area) {
+                real_point normal(-e.y * height, e.x * height);
+                real_point low = a + real_point(e.x * lo, e.y * lo), high = a + real_point(e.x * hi, e.y * hi);
+                best = { { low, high, high + normal, low + normal }, rectangleArea };
+            }
+        }
+        return best;
     }
 };
 
-// Encapsulates the functions related to the divide-and-conquer approach to
-// finding the convex hull.
-class Algorithm2 {
+/* Part 11 : Convex layers */
+
+// Onion peeling : the first layer is the hull of the points, the second one the hull of the points left
+// once the first layer is removed, and so on. Peeling by repeated calls to convex_hull_sweeping makes a
+// pass over the remaining points for every layer, and the uniform datasets have about n^(2/3) layers.
+// Here the points are sorted once, the distinct points are the leaves of a DynamicHull built bottom-up in
+// that order, and each layer is read from the tree then erased from it in one batch, O(log^2 n) per point
+// at most : O(n log^2 n) in all. Like the sweeping, a layer keeps the points inside its edges, and the
+// copies of a point are in the same layer.
+
+template <typename T>
+vector<int> convex_layers(const vector<basic_point<T>>& points, int* nb_layers=nullptr){
+    // Layer of each point, 0 for the points of the hull
+    int n=points.size();
+    vector<int> order(n);
+    iota(all(order), 0);
+    sort(all(order), [&](int i, int j){ return point_cmp(points[i], points[j]); });
+    // The distinct points in order, and for each one the first of its copies in 'order'
+    vector<basic_point<T>> distinct;
+    vector<int> copies;
+    forn(k,n){
+        if (k>0 && points[order[k]]==points[order[k-1]]) continue;
+        distinct.push_back(points[order[k]]);
+        copies.push_back(k);
+    }
+    copies.push_back(n);
+    vector<int> distinct_layer(distinct.size(), -1);
+    DynamicHull<T> remaining(distinct);
+    int layer=0;
+    vector<basic_point<T>> peeled;
+    for (; remaining.size()>0; layer++){
+        peeled.clear();
+        for (const auto& p : remaining.hull()){
+            int i=lower_bound(all(distinct), p, point_cmp<T>)-distinct.begin();
+            if (distinct_layer[i]>=0) continue; // A flat hull goes twice through its inner points
+            distinct_layer[i]=layer;
+            peeled.push_back(p);
+        }
+        remaining.erase(peeled);
+    }
+    vector<int> res(n);
+    forn(i,(int)distinct.size()) for (int k=copies[i]; k<copies[i+1]; k++) res[order[k]]=distinct_layer[i];
+    if (nb_layers) *nb_layers=layer;
+    return res;
+}
+
+/* Part 12 : Sliding-window hull */
+
+// Hull of the last points of a stream : the last 'capacity' points, and/or the points more recent than a
+// given time. The window is a queue made of two stacks. The new points go to the back, whose hull is
+// updated at each arrival. When the oldest point leaves and the front is empty, the back becomes the
+// front, in arrival order, with the hulls of its aligned blocks of 2, 4, 8, ... points : the points still
+// in the front are then the union of O(log W) blocks. A hull is kept as its vertices (and the points
+// inside its edges) in lexicographic order, so that the hull of the union of two hulls is a merge and a
+// sweep, in linear time. An arrival costs O(h). Moving the back to the front rebuilds every level, which
+// holds up to W points when most of them are on the hull : it costs O(W log W) and a departure O(log W)
+// amortized. Reading the hull costs O(h log W), where recomputing it costs O(W log W).
+
+template <typename T>
+class SlidingHull {
 private:
-    std::vector<point> data;
-public:
-    // Subroutine for the main algorithm. Is used recursively.
-    std::vector<point> applyAlgorithm(std::vector<point> points) {
-        if (points.size() <= 2)
-            return points;
-        point p_m{ MedianList<point>::findMedian(points) };
-        std::vector<point> shuffled{ shuffle(points) };
+    using point = basic_point<T>;
 
-        point mini{ *std::min_element(points.begin(), points.end()) };
-        point maxi{ *std::max_element(points.begin(), points.end()) };
+    // Hulls of the blocks [k 2^l, (k+1) 2^l) of the front for one level l >= 1, one after the other
+    struct Level {
+        std::vector<point> points;
+        std::vector<int> starts; // Block k is points[starts[k], starts[k+1])
+    };
 
-        // Base points.
-        point p1{ mini }, p2{ maxi };
+    size_t capacity;
+    std::vector<point> front, back; // In arrival order
+    std::vector<double> frontTimes, backTimes;
+    size_t frontBegin = 0;          // The points of the front before it have left the window
+    std::vector<Level> levels;      // levels[l-1] for the level l, reused from one move to the next
+    int nbLevels = 0;               // Levels of the current front
+    std::vector<point> backHull;
+    // Work buffers of unite() and hull()
+    mutable hull_scratch<T> scratch;
+    mutable std::vector<point> united, acc;
 
-        ld lowestY = findIntersectionY(p_m.x, p1, p2);
-        for (int k = 0; k < (int)points.size(); ++k) {
-            point p = points[k];
-            if (p == p1 || p == p2)
-                continue;
-            if (findIntersectionY(p.x, p1, p2) >= p.y)
-                continue;
-            p1 = p;
-            p2 = p1.x > p_m.x ? mini : maxi;
-            lowestY = -INFINITY;
-            for (int i = 0; i < k; ++i) {
-                if ((p1.x - p_m.x) * (points[i].x - p_m.x) > 0.)
-                    continue;
-                std::tuple cur = std::tuple(findIntersectionY(p_m.x, p1, points[i]), p1, points[i]);
-                tie(lowestY, p1, p2) = std::max(std::tuple(lowestY, p1, p2), cur, [](std::tuple<ld, point, point> q1, std::tuple<ld, point, point> q2) { return std::get<0>(q1) < std::get<0>(q2); });
-            }
-            if (p1.x > p2.x)
-                swap(p1, p2);
-        }
+    // Hull of the union of the hulls a and b, in 'res', which must be distinct from both.
+    void unite(const point* a, int na, const point* b, int nb, std::vector<point>& res) const {
+        res.clear();
+        unite_hulls(a, na, b, nb, res, scratch);
+    }
 
-        // Create recursive cases.
-        std::vector<point> res, lo, hi;
-        for (auto p : points) {
-            if (p.x <= p1.x)
-                lo.push_back(p);
-            else if (p.x >= p2.x)
-                hi.push_back(p);
+    // Hull of the block k of the level l of the front (the point k for l = 0), empty past the end.
+    std::pair<const point*, int> block(int l, int k) const {
+        if (l == 0)
+            return { front.data() + k, k < (int)front.size() ? 1 : 0 };
+        const Level& level = levels[l - 1];
+        if (k + 1 >= (int)level.starts.size())
+            return { nullptr, 0 };
+        return { level.points.data() + level.starts[k], level.starts[k + 1] - level.starts[k] };
+    }
+
+    void moveBackToFront() {
+        std::swap(front, back);
+        std::swap(frontTimes, backTimes);
+        back.clear();
+        backTimes.clear();
+        backHull.clear();
+        frontBegin = 0;
+        int m = front.size();
+        for (nbLevels = 0; (1 << nbLevels) < m; ++nbLevels) {}
+        if ((int)levels.size() < nbLevels)
+            levels.resize(nbLevels);
+        for (int l = 1; l <= nbLevels; ++l) {
+            Level& level = levels[l - 1];
+            level.points.clear();
+            level.starts.clear();
+            for (int k = 0; k << l < m; ++k) {
+                auto [a, na] = block(l - 1, 2 * k);
+                auto [b, nb] = block(l - 1, 2 * k + 1);
+                unite(a, na, b, nb, united);
+                level.starts.push_back(level.points.size());
+                level.points.insert(level.points.end(), united.begin(), united.end());
+            }
+            level.starts.push_back(level.points.size());
         }
-        std::vector<point> loPoints = applyAlgorithm(lo);
-        std::vector<point> hiPoints = applyAlgorithm(hi);
+    }
 
-        // Reconstitute the final answer.
-        for (auto p : loPoints)
-            res.push_back(p);
-        res.push_back(p1);
-        res.push_back(p2);
-        for (auto p : hiPoints)
-            res.push_back(p);
-        
-        return res;
+    // Removes the oldest point.
+    void pop() {
+        if (frontBegin == front.size())
+            moveBackToFront();
+        ++frontBegin;
     }
 
-    // Assumes 'p1' != 'p2'. Finds the y-coordinate of the point of (p1, p2)
-    // whose x-coordinate is 'x_m'.
-    long double findIntersectionY(ld x_m, point p1, point p2) {
-        return (p2.y - p1.y) / (p2.x - p1.x) * (x_m - p1.x) + p1.y;
+public:
+    explicit SlidingHull(size_t capacity = std::numeric_limits<size_t>::max()): capacity{ capacity } {
+        assert(capacity > 0);
     }
 
-    std::vector<point> shuffle(std::vector<point> points) {
-        std::vector<point> shuffled{ points };
-        std::shuffle(points.begin(), points.end(), rng);
-        
-        return shuffled;
+    // Number of points in the window.
+    size_t size() const {
+        return front.size() - frontBegin + back.size();
     }
 
-    std::vector<point> startAlgorithm() {
-        std::vector<point> lst1{ applyAlgorithm(data) };
+    // Adds a point, the oldest one leaving if the window is full. The times must not decrease.
+    void push(const point& p, double time = 0) {
+        assert(back.empty() ? frontBegin == front.size() || frontTimes.back() <= time : backTimes.back() <= time);
+        if (size() == capacity)
+            pop();
+        back.push_back(p);
+        backTimes.push_back(time);
+        unite(backHull.data(), backHull.size(), &p, 1, united);
+        std::swap(backHull, united);
+    }
 
-        // Points flipped around the y = 0 axis in order to find the lower hull.
-        std::vector<point> negData{ data };
-        for (auto& x : negData)
-            x.y = -x.y;
-        
-        std::vector<point> lst2 = applyAlgorithm(negData);
-        for (auto& x : lst2)
-            x.y = -x.y;
-        
-        // Delete redundance with the upper hull.
-        lst2.erase(prev(lst2.end()));
-        lst2.erase(lst2.begin());
+    // Removes the points older than 'time'.
+    void expire(double time) {
+        while (size() > 0 && (frontBegin < front.size() ? frontTimes[frontBegin] : backTimes.front()) < time)
+            pop();
+    }
 
-        reverse(lst2.begin(), lst2.end());
-        std::vector<point> res{ lst1 };
-        for (auto x : lst2)
-            res.push_back(x);
-        auto it { std::unique(res.begin(), res.end()) };
-        res.erase(it, res.end());
-    
+    // Hull of the window, same result as convex_hull_sweeping on its points.
+    std::vector<point> hull() const {
+        acc = backHull;
+        for (int pos = frontBegin, m = front.size(); pos < m;) {
+            // Largest block of the front starting at pos
+            int l = pos == 0 ? nbLevels : std::min(nbLevels, __builtin_ctz(pos));
+            auto [b, nb] = block(l, pos >> l);
+            unite(acc.data(), acc.size(), b, nb, united);
+            std::swap(acc, united);
+            pos += 1 << l;
+        }
+        // The vertices in lexicographic order, then in the order of the sweeping
+        scratch.upper.clear();
+        scratch.lower.clear();
+        sweep_pass(acc.begin(), acc.end(), scratch.upper);
+        sweep_pass(acc.rbegin(), acc.rend(), scratch.lower);
+        std::vector<point> res{ scratch.upper };
+        for (int j = 1; j < (int)scratch.lower.size() - 1; ++j)
+            res.push_back(scratch.lower[j]);
         return res;
     }
-
-    Algorithm2(std::vector<point> points): data{ points } {}
 };
 
-int main() {
+#if defined(PERF_ALLOC) || defined(HULL_STATS)
+// Every heap allocation goes through these operators so that the perf driver can count them.
+// The size of each block is stored in front of it to follow the live heap size. The counters are
+// atomic : the threads of the parallel algorithms allocate too.
+atomic<size_t> nb_allocations{0}, allocated_bytes{0}, live_bytes{0}, peak_live_bytes{0};
+
+void* operator new(size_t size){
+    STATS_ADD(bytes_allocated, size);
+    nb_allocations.fetch_add(1, memory_order_relaxed);
+    allocated_bytes.fetch_add(size, memory_order_relaxed);
+    size_t live=live_bytes.fetch_add(size, memory_order_relaxed)+size;
+    size_t peak=peak_live_bytes.load(memory_order_relaxed);
+    while (live>peak && !peak_live_bytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+    char* block=(char*)malloc(size+sizeof(max_align_t));
+    if (!block) throw bad_alloc();
+    *(size_t*)block=size;
+    return block+sizeof(max_align_t);
+}
+
+// Not inlined : GCC would then see free() on a pointer returned by operator new and warn
+[[gnu::noinline]] void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    char* block=(char*)ptr-sizeof(max_align_t);
+    live_bytes.fetch_sub(*(size_t*)block, memory_order_relaxed);
+    free(block);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+#endif
+
+#ifndef CONVEX_HULL_LIBRARY
+int main(int argc, char** argv) {
+    #ifdef CONVERT
+        // ./convert_points input output [float|double|long_double] [precision]
+        // Binary point file to text, or text to a binary point file of the given scalar (long double by default).
+        // The text is written with 'precision' digits after the point, or exactly with a negative precision.
+        if (argc<3){
+            cerr<<"Usage : "<<argv[0]<<" input output [float|double|long_double] [precision]\n";
+            return 1;
+        }
+        string scalar=(argc>3 ? argv[3] : "long_double");
+        int precision=(argc>4 ? atoi(argv[4]) : PRECISION);
+        try {
+            convert_point_file(argv[1], argv[2], scalar=="float" ? SCALAR_FLOAT : scalar=="double" ? SCALAR_DOUBLE : SCALAR_LONG_DOUBLE, precision);
+        }
+        catch (const exception& e){
+            cerr<<e.what()<<"\n";
+            return 1;
+        }
+        return 0;
+    #endif
+
     // In/out optimization
     cin.tie(0);
 
-    cout<<"Results will be displayed in resultsX.txt\n";
-    vector<point> data[4];
+    cout<<"Results will be displayed in resultsX.bin\n";
+    vector<point> data[NB_DATASETS];
 
     freopen("results.txt", "w", stdout);
-    #ifdef PERF
-        cerr<<"All times are averaged over " << NB_ITER << " independant runs\n";
-        vector<clock_t> times_sweep(4);
-        vector<clock_t> times_dnc(4);
-        vector<point> res[4];
+    #ifdef PERF_PARALLEL
+        // Wall-clock time here : clock() adds up the CPU time of every thread
+        using wall_clock = chrono::steady_clock;
+        int max_threads=max(1u, thread::hardware_concurrency());
+        vector<int> nb_threads;
+        for (int t=1; t<max_threads; t*=2) nb_threads.push_back(t);
+        nb_threads.push_back(max_threads);
+        cerr<<"Parallel sweep and dnc on "<<NBPOINTS<<" points, up to "<<max_threads<<" threads\n";
+        forn(i,4){
+            switch (i)
+            {
+            case 0:
+                data[0] = genA(NBPOINTS);
+                break;
+            case 1:
+                data[1] = genB(NBPOINTS);
+                break;
+            case 2:
+                data[2] = genC(NBPOINTS);
+                break;
+            case 3:
+                data[3] = genD(NBPOINTS);
+                break;
+            }
+            vector<point> copy{ data[i] };
+            auto start=wall_clock::now();
+            vector<point> reference=convex_hull_sweeping(copy);
+            chrono::duration<double> serial_time=wall_clock::now()-start;
+            cerr<<"Dataset "<<(char)('A'+i)<<" : serial sweep took "<<serial_time.count()<<" seconds\n";
+            for (int t : nb_threads){
+                copy=data[i];
+                start=wall_clock::now();
+                vector<point> res=convex_hull_sweeping_parallel(copy, t);
+                chrono::duration<double> parallel_time=wall_clock::now()-start;
+                bool same=res.size()==reference.size() && equal(all(res), reference.begin(), [](point a, point b){ return a==b; });
+                cerr<<"    "<<t<<" threads : "<<parallel_time.count()<<" seconds, speedup "<<serial_time.count()/parallel_time.count();
+                cerr<<(same ? ", same hull\n" : ", DIFFERENT HULL\n");
+            }
+            Algorithm2 serial_dnc(data[i]);
+            start=wall_clock::now();
+            reference=serial_dnc.startAlgorithmInPlace();
+            serial_time=wall_clock::now()-start;
+            cerr<<"Dataset "<<(char)('A'+i)<<" : serial dnc (in place) took "<<serial_time.count()<<" seconds\n";
+            for (int t : nb_threads){
+                Algorithm2 parallel_dnc(data[i]);
+                start=wall_clock::now();
+                vector<point> res=parallel_dnc.startAlgorithmParallel(t);
+                chrono::duration<double> parallel_time=wall_clock::now()-start;
+                bool same=(res==reference);
+                cerr<<"    "<<t<<" threads : "<<parallel_time.count()<<" seconds, speedup "<<serial_time.count()/parallel_time.count();
+                cerr<<(same ? ", same hull\n" : ", DIFFERENT HULL\n");
+            }
+        }
+    #endif
+
+    #ifdef PERF_ALLOC
+        using wall_clock = chrono::steady_clock;
+        cerr<<"Heap usage of one run of Algorithm2 and of the sweeping on "<<NBPOINTS<<" points (peak heap is counted from the start of the run)\n";
+        auto measure = [&](const char* mode, auto&& run){
+            size_t start_allocations=nb_allocations, start_bytes=allocated_bytes;
+            peak_live_bytes=live_bytes.load();
+            size_t start_live=live_bytes;
+            auto start=wall_clock::now();
+            size_t hull_size=run();
+            chrono::duration<double> time=wall_clock::now()-start;
+            cerr<<"    "<<setw(25)<<left<<mode<<right<<" : "<<time.count()<<" s, "<<nb_allocations-start_allocations<<" allocations, ";
+            cerr<<(allocated_bytes-start_bytes)/1024<<" KiB allocated, peak heap "<<(peak_live_bytes-start_live)/1024<<" KiB, hull of "<<hull_size<<" points\n";
+        };
+        sweep_workspace<ld> workspace; // Reused by every run of convex_hull_sweeping_into
         forn(i,4){
+            switch (i)
+            {
+            case 0:
+                data[0] = genA(NBPOINTS);
+                break;
+            case 1:
+                data[1] = genB(NBPOINTS);
+                break;
+            case 2:
+                data[2] = genC(NBPOINTS);
+                break;
+            case 3:
+                data[3] = genD(NBPOINTS);
+                break;
+            }
+            cerr<<"Dataset "<<(char)('A'+i)<<" :\n";
+            Algorithm2 copies(data[i]), in_place(data[i]);
+            measure("dnc, copies", [&](){ return copies.startAlgorithm().size(); });
+            measure("dnc, in place", [&](){ return in_place.startAlgorithmInPlace().size(); });
+            // The sweeping sorts its input : every run gets a shuffled copy, made before the measure
+            vector<point> input;
+            auto shuffled=[&](){
+                input=data[i];
+                shuffle(all(input), rng);
+            };
+            shuffled();
+            measure("sweeping", [&](){ return convex_hull_sweeping(input).size(); });
+            shuffled();
+            measure("sweeping into workspace", [&](){ return convex_hull_sweeping_into(input, workspace).size(); });
+            shuffled();
+            measure("  again, same workspace", [&](){ return convex_hull_sweeping_into(input, workspace).size(); });
+        }
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        cerr<<"Peak RSS of the process : "<<usage.ru_maxrss<<" KiB\n";
+    #endif
+
+    #ifdef PERF_LAYOUT
+        using wall_clock = chrono::steady_clock;
+        cerr<<"All times are averaged over " << NB_ITER << " independant runs, hull sizes are given in brackets\n";
+        // Average wall time of 'run' over NB_ITER fresh copies of 'points'
+        auto average_time = [](const auto& points, auto run){
+            chrono::duration<double> total{ 0 };
             forn(j,NB_ITER){
-                switch (i)
-                {
-                case 0:
-                    data[0] = genA(NBPOINTS);
-                    break;
-                case 1:
-                    data[1] = genB(NBPOINTS);
-                    break;
-                case 2:
-                    data[2] = genC(NBPOINTS);
-                    break;
-                case 3:
-                    data[3] = genD(NBPOINTS);
-                    break;
+                auto copy{ points };
+                auto start=wall_clock::now();
+                run(copy);
+                total+=wall_clock::now()-start;
+            }
+            return total.count()/NB_ITER;
+        };
+        auto report = [&](const char* layout, const auto& points, size_t bytes_per_point){
+            auto copy{ points };
+            size_t hull_size=convex_hull_sweeping(copy).size();
+            double sweep=average_time(points, [](auto& p){ convex_hull_sweeping(p); });
+            cerr<<"    "<<setw(16)<<left<<layout<<right<<" ("<<setw(2)<<bytes_per_point<<" bytes/point) : ";
+            cerr<<"sweep "<<sweep<<" s ["<<hull_size<<"], ";
+            double dnc=average_time(points, [](auto& p){ Algorithm2 tmp(p); tmp.startAlgorithm(); });
+            cerr<<"dnc "<<dnc<<" s\n";
+        };
+        forn(i,4){
+            switch (i)
+            {
+            case 0:
+                data[0] = genA(NBPOINTS);
+                break;
+            case 1:
+                data[1] = genB(NBPOINTS);
+                break;
+            case 2:
+                data[2] = genC(NBPOINTS);
+                break;
+            case 3:
+                data[3] = genD(NBPOINTS);
+                break;
+            }
+            cerr<<"Dataset "<<(char)('A'+i)<<" :\n";
+            report("AoS long double", data[i], sizeof(point));
+            report("AoS double", convert_points<double>(data[i]), sizeof(basic_point<double>));
+            report("AoS float", convert_points<float>(data[i]), sizeof(basic_point<float>));
+            report("SoA double", point_soa<double>(convert_points<double>(data[i])), 2*sizeof(double));
+            report("SoA float", point_soa<float>(convert_points<float>(data[i])), 2*sizeof(float));
+        }
+    #endif
+
+    #ifdef PERF_DYNAMIC
+        using wall_clock = chrono::steady_clock;
+        // Each step inserts the next point of a stream of 2*NBPOINTS points. Once there are NBPOINTS
+        // live points, it also deletes a random one. The hull is queried every QUERY_PERIOD steps,
+        // from the dynamic hull or by running the sweeping again on the live points.
+        const int QUERY_PERIOD=1000;
+        cerr<<"Streams of "<<2*NBPOINTS<<" steps on up to "<<NBPOINTS<<" live points, hull queried every "<<QUERY_PERIOD<<" steps\n";
+        forn(i,2){
+            vector<point> stream=(i==0 ? genB(2*NBPOINTS) : genC(2*NBPOINTS));
+            DynamicHull<ld> dynamic_hull;
+            vector<point> live;
+            chrono::duration<double> updates{ 0 }, queries{ 0 }, recomputations{ 0 };
+            int nb_updates=0, nb_queries=0;
+            bool same=true;
+            forn(j,2*NBPOINTS){
+                auto start=wall_clock::now();
+                dynamic_hull.insert(stream[j]);
+                nb_updates++;
+                live.push_back(stream[j]);
+                if ((int)live.size()>NBPOINTS){
+                    int k=rng()%live.size();
+                    dynamic_hull.erase(live[k]);
+                    nb_updates++;
+                    live[k]=live.back();
+                    live.pop_back();
+                }
+                updates+=wall_clock::now()-start;
+                if ((j+1)%QUERY_PERIOD==0){
+                    start=wall_clock::now();
+                    vector<point> hull{ dynamic_hull.hull() };
+                    queries+=wall_clock::now()-start;
+                    start=wall_clock::now();
+                    vector<point> input{ live };
+                    vector<point> recomputed{ convex_hull_sweeping(input) };
+                    recomputations+=wall_clock::now()-start;
+                    nb_queries++;
+                    same&=(hull==recomputed);
+                }
+            }
+            cerr<<"Dataset "<<(char)('B'+i)<<" : "<<(same ? "same hulls" : "DIFFERENT HULLS")<<"\n";
+            cerr<<"    dynamic hull  : "<<updates.count()/nb_updates*1e6<<" us per update, "<<queries.count()/nb_queries*1e6<<" us per query, ";
+            cerr<<(updates+queries).count()<<" s in total\n";
+            cerr<<"    recomputation : "<<recomputations.count()/nb_queries*1e6<<" us per query, "<<recomputations.count()<<" s in total\n";
+        }
+    #endif
+
+    #ifdef PERF_QUERIES
+        using wall_clock = chrono::steady_clock;
+        // Point-in-hull and extreme point queries on the hull of NBPOINTS points of datasets B, C and D :
+        // linear scans of the hull, as before the index, against HullIndex one query at a time and by
+        // batches. The linear scans only run on as many queries as their time allows.
+        const int NB_QUERIES=4*NBPOINTS;
+        int max_threads=max(1u, thread::hardware_concurrency());
+        auto seconds_since=[](wall_clock::time_point start){ return chrono::duration<double>(wall_clock::now()-start).count(); };
+        vector<point> queries=genB(NB_QUERIES);
+        vector<point> directions(NB_QUERIES);
+        forn(k,NB_QUERIES) directions[k]=queries[k]-point(0.5, 0.5);
+        for (int i=1; i<4; i++){
+            data[i]=gen_dataset('A'+i, NBPOINTS);
+            vector<point> hull=convex_hull_sweeping(data[i]);
+            int h=hull.size();
+            cerr<<"Dataset "<<(char)('A'+i)<<" : hull of "<<h<<" points, "<<NB_QUERIES<<" queries\n";
+            auto start=wall_clock::now();
+            HullIndex<ld> index(hull);
+            cerr<<"    index built in "<<seconds_since(start)<<" s\n";
+
+            int nb_linear=min(NB_QUERIES, max(1, (1<<26)/h));
+            vector<uint8_t> linear_inside(nb_linear);
+            vector<int> linear_extreme(nb_linear);
+            start=wall_clock::now();
+            forn(k,nb_linear){
+                bool inside=true;
+                forn(j,h) inside&=orient_sign(hull[j], hull[(j+1)%h], queries[k])<=0;
+                linear_inside[k]=inside;
+            }
+            double linear_contains=seconds_since(start)/nb_linear;
+            start=wall_clock::now();
+            forn(k,nb_linear){
+                auto dot=[&](const point& p){ return p.x*directions[k].x+p.y*directions[k].y; };
+                linear_extreme[k]=max_element(all(hull), [&](const point& a, const point& b){ return dot(a)<dot(b); })-hull.begin();
+            }
+            double linear_extreme_time=seconds_since(start)/nb_linear;
+
+            start=wall_clock::now();
+            vector<uint8_t> inside(NB_QUERIES);
+            forn(k,NB_QUERIES) inside[k]=index.contains(queries[k]);
+            double single_contains=seconds_since(start)/NB_QUERIES;
+            start=wall_clock::now();
+            vector<uint8_t> batch_inside=index.contains(queries, 1);
+            double batch_contains=seconds_since(start)/NB_QUERIES;
+            start=wall_clock::now();
+            vector<uint8_t> parallel_inside=index.contains(queries, max_threads);
+            double parallel_contains=seconds_since(start)/NB_QUERIES;
+            bool same=equal(all(linear_inside), inside.begin()) && inside==batch_inside && inside==parallel_inside;
+            cerr<<"    contains : linear scan "<<linear_contains*1e9<<" ns, index "<<single_contains*1e9<<" ns, batch "<<batch_contains*1e9;
+            cerr<<" ns, "<<max_threads<<" threads "<<parallel_contains*1e9<<" ns per query, "<<count(all(inside), 1)<<" inside, ";
+            cerr<<(same ? "same answers" : "DIFFERENT ANSWERS")<<"\n";
+
+            start=wall_clock::now();
+            vector<int> extreme(NB_QUERIES);
+            forn(k,NB_QUERIES) extreme[k]=index.extreme(directions[k]);
+            double single_extreme=seconds_since(start)/NB_QUERIES;
+            start=wall_clock::now();
+            vector<int> batch_extreme=index.extreme(directions, 1);
+            double batch_extreme_time=seconds_since(start)/NB_QUERIES;
+            start=wall_clock::now();
+            vector<int> parallel_extreme=index.extreme(directions, max_threads);
+            double parallel_extreme_time=seconds_since(start)/NB_QUERIES;
+            // On ties, the index and the scan can return different points with the same dot product
+            same=extreme==batch_extreme && extreme==parallel_extreme;
+            forn(k,nb_linear){
+                auto dot=[&](int j){ return hull[j].x*directions[k].x+hull[j].y*directions[k].y; };
+                same&=(dot(extreme[k])==dot(linear_extreme[k]));
+            }
+            cerr<<"    extreme  : linear scan "<<linear_extreme_time*1e9<<" ns, index "<<single_extreme*1e9<<" ns, batch "<<batch_extreme_time*1e9;
+            cerr<<" ns, "<<max_threads<<" threads "<<parallel_extreme_time*1e9<<" ns per query, "<<(same ? "same answers" : "DIFFERENT ANSWERS")<<"\n";
+
+            start=wall_clock::now();
+            auto diameter=index.diameter();
+            ld width=index.width();
+            auto rectangle=index.minAreaRectangle();
+            cerr<<"    calipers : diameter "<<diameter.length<<", width "<<width<<", minimum rectangle area "<<rectangle.area;
+            cerr<<" in "<<seconds_since(start)<<" s\n";
+        }
+    #endif
+
+    #ifdef PERF_LAYERS
+        using wall_clock = chrono::steady_clock;
+        // Convex layers of datasets A to D : convex_layers against the loop that computes the hull of the
+        // remaining points with convex_hull_sweeping and removes its points, for growing sizes. The loop
+        // stops once it takes more than a few seconds, the next size would take minutes.
+        auto seconds_since=[](wall_clock::time_point start){ return chrono::duration<double>(wall_clock::now()-start).count(); };
+        auto repeated_hulls=[](const vector<point>& points, int& nb_layers){
+            vector<point> remaining{ points };
+            vector<int> ids(points.size()), res(points.size());
+            iota(all(ids), 0);
+            for (nb_layers=0; !remaining.empty(); nb_layers++){
+                vector<point> input{ remaining };
+                vector<point> hull=convex_hull_sweeping(input);
+                sort(all(hull), point_cmp<ld>);
+                int kept=0;
+                forn(k,(int)remaining.size()){
+                    if (binary_search(all(hull), remaining[k], point_cmp<ld>)) res[ids[k]]=nb_layers;
+                    else {
+                        remaining[kept]=remaining[k];
+                        ids[kept++]=ids[k];
+                    }
+                }
+                remaining.resize(kept);
+                ids.resize(kept);
+            }
+            return res;
+        };
+        forn(i,4){
+            double naive_time=0;
+            for (int n=NBPOINTS/100; n<=NBPOINTS; n*=10){
+                vector<point> points{ gen_dataset('A'+i, n) };
+                int nb_layers=0, naive_layers=0;
+                auto start=wall_clock::now();
+                vector<int> layers=convex_layers(points, &nb_layers);
+                double time=seconds_since(start);
+                cerr<<"Dataset "<<(char)('A'+i)<<", "<<n<<" points : "<<nb_layers<<" layers, convex_layers "<<time<<" s";
+                if (naive_time<6){
+                    start=wall_clock::now();
+                    vector<int> naive=repeated_hulls(points, naive_layers);
+                    naive_time=seconds_since(start);
+                    cerr<<", repeated hulls "<<naive_time<<" s ("<<naive_time/time<<"x), "<<(naive==layers ? "same layers" : "DIFFERENT LAYERS");
                 }
-                times_sweep[i]-=clock();
-                res[i]=convex_hull_sweeping(data[i]);
-                times_sweep[i]+=clock();
-                times_dnc[i]-=clock();
-                Algorithm2 tmp(data[i]);
-                res[i]=tmp.startAlgorithm();
-                times_dnc[i]+=clock();
-            }
-            times_sweep[i]/=((ld)(NB_ITER));
-            times_dnc[i]/=((ld)(NB_ITER));
-            cerr<<"Sweep for dataset "<<(char)('A'+i)<<" took "<<(times_sweep[i])*1.0/CLOCKS_PER_SEC<<" seconds on average\n";
-            cerr<<"Dnc for dataset "<<(char)('A'+i)<<" took "<<(times_dnc[i])*1.0/CLOCKS_PER_SEC<<" seconds on average\n";
-        }
-        freopen("resultsA.txt", "w", stdout);
-        for (auto pt : res[0]) cout<<pt.x<<" "<<pt.y<<"\n";
-        freopen("resultsB.txt", "w", stdout);
-        for (auto pt : res[1]) cout<<pt.x<<" "<<pt.y<<"\n";
-        freopen("resultsC.txt", "w", stdout);
-        for (auto pt : res[2]) cout<<pt.x<<" "<<pt.y<<"\n";
-        freopen("resultsD.txt", "w", stdout);
-        for (auto pt : res[3]) cout<<pt.x<<" "<<pt.y<<"\n";
+                cerr<<"\n";
+            }
+        }
+    #endif
+
+    #ifdef PERF_WINDOW
+        using wall_clock = chrono::steady_clock;
+        // Hull of the last W points of a stream of points of dataset C, for W from 1e3 to NBPOINTS : events
+        // per second of SlidingHull, with and without reading the hull after each arrival, against
+        // convex_hull_sweeping on the window after each arrival. After the first W points, every event
+        // makes a point leave the window. The hull is read on the first 2^17 events only, and the
+        // recomputation runs on as many events as its time allows.
+        auto seconds_since=[](wall_clock::time_point start){ return chrono::duration<double>(wall_clock::now()-start).count(); };
+        for (int w=1000; w<=NBPOINTS; w*=10){
+            const int nb_events=max(2*w, 1<<17), nb_read=1<<17, nb_recomputed=min(nb_events, max(10, (1<<26)/w));
+            vector<point> stream{ genC(w+nb_events) };
+            SlidingHull<ld> window(w);
+            forn(k,w) window.push(stream[k]);
+            auto start=wall_clock::now();
+            for (int k=w; k<w+nb_events; k++) window.push(stream[k]);
+            double updates=nb_events/seconds_since(start);
+
+            SlidingHull<ld> read_window(w);
+            forn(k,w) read_window.push(stream[k]);
+            size_t total=0;
+            start=wall_clock::now();
+            for (int k=w; k<w+nb_read; k++){
+                read_window.push(stream[k]);
+                total+=read_window.hull().size();
+            }
+            double reads=nb_read/seconds_since(start);
+
+            // The hulls of the recomputation are compared to the ones of SlidingHull
+            SlidingHull<ld> checked_window(w);
+            forn(k,w) checked_window.push(stream[k]);
+            bool same=true;
+            double recomputation_time=0;
+            for (int k=w; k<w+nb_recomputed; k++){
+                checked_window.push(stream[k]);
+                start=wall_clock::now();
+                vector<point> input(stream.begin()+k+1-w, stream.begin()+k+1);
+                vector<point> hull=convex_hull_sweeping(input);
+                recomputation_time+=seconds_since(start);
+                same&=(hull==checked_window.hull());
+            }
+            double recomputations=nb_recomputed/recomputation_time;
+            cerr<<"W = "<<w<<" : "<<updates<<" updates/s, "<<reads<<" events/s reading the hull (mean hull of "<<total/nb_read;
+            cerr<<" points), recomputation "<<recomputations<<" events/s ("<<reads/recomputations<<"x), "<<(same ? "same hulls" : "DIFFERENT HULLS")<<"\n";
+        }
+    #endif
+
+    #ifdef PERF_INTEGER
+        using wall_clock = chrono::steady_clock;
+        // Fixed-point coordinates against the floating-point ones on datasets A to D : the points are
+        // quantized on grids of 2^31 (int32_t) and 2^62 (int64_t) cells. Fixed-point hulls are exact
+        // without fallback, and must agree between the algorithms.
+        auto bench=[&](auto points, const char* name){
+            using P=typename decltype(points)::value_type;
+            auto time_of=[&](auto&& algorithm){
+                auto input=points;
+                long long fallbacks=orient_fallbacks;
+                auto start=wall_clock::now();
+                vector<P> hull=algorithm(input);
+                double time=chrono::duration<double>(wall_clock::now()-start).count();
+                return tuple(time, hull, orient_fallbacks-fallbacks);
+            };
+            auto [sweep_time, sweep, sweep_fallbacks]=time_of([](auto& p){ return convex_hull_sweeping(p); });
+            auto [quick_time, quick, quick_fallbacks]=time_of([](auto& p){ return convex_hull_quickhull(p); });
+            auto [dnc_time, dnc, dnc_fallbacks]=time_of([](auto& p){ Algorithm2 tmp(p); return tmp.startAlgorithmInPlace(); });
+            sort(all(dnc));
+            vector<P> sorted_sweep{ sweep };
+            sort(all(sorted_sweep));
+            cerr<<"    "<<setw(12)<<left<<name<<right<<" ("<<sizeof(P)<<" bytes per point) : sweep "<<sweep_time<<" s, quickhull "<<quick_time;
+            cerr<<" s, dnc in place "<<dnc_time<<" s, "<<sweep_fallbacks+quick_fallbacks+dnc_fallbacks<<" exact fallbacks, hull of ";
+            cerr<<sweep.size()<<" points, "<<(quick==sweep && dnc==sorted_sweep ? "same hulls" : "DIFFERENT HULLS")<<"\n";
+        };
+        forn(i,4){
+            data[i]=gen_dataset('A'+i, NBPOINTS);
+            cerr<<"Dataset "<<(char)('A'+i)<<" ("<<NBPOINTS<<" points)\n";
+            bench(data[i], "long double");
+            bench(convert_points<double>(data[i]), "double");
+            bench(quantize_points<int32_t>(data[i], 31), "int32_t");
+            bench(quantize_points<int64_t>(data[i], 62), "int64_t");
+        }
+    #endif
+
+    #ifdef PERF_SORT
+        using wall_clock = chrono::steady_clock;
+        // The pre-sort of the sweeping against std::sort, on datasets A to D in random order, already
+        // sorted, and sorted with 0.1% of the points swapped, for long double and double coordinates
+        auto bench=[&](auto points, const char* name){
+            using P=typename decltype(points)::value_type;
+            using T=decltype(P::x);
+            auto time_of=[&](auto&& sorter){
+                auto input=points;
+                auto start=wall_clock::now();
+                sorter(input);
+                return pair(chrono::duration<double>(wall_clock::now()-start).count(), input);
+            };
+            auto [std_time, reference]=time_of([](auto& p){ sort(all(p), point_cmp<T>); });
+            auto [radix_time, radix]=time_of([](auto& p){ sort_points(p.data(), p.data()+p.size()); });
+            int nb_threads=thread::hardware_concurrency();
+            auto [parallel_time, parallel]=time_of([&](auto& p){ sort_points(p.data(), p.data()+p.size(), nb_threads); });
+            cerr<<"    "<<setw(28)<<left<<name<<right<<" std::sort "<<std_time<<" s, sort_points "<<radix_time<<" s (x"<<std_time/radix_time<<"), ";
+            cerr<<nb_threads<<" threads "<<parallel_time<<" s (x"<<std_time/parallel_time<<"), ";
+            cerr<<(radix==reference && parallel==reference ? "same order" : "DIFFERENT ORDER")<<"\n";
+        };
+        forn(i,4){
+            data[i]=gen_dataset('A'+i, NBPOINTS);
+            cerr<<"Dataset "<<(char)('A'+i)<<" ("<<NBPOINTS<<" points)\n";
+            vector<point> sorted{ data[i] };
+            sort(all(sorted), point_cmp<ld>);
+            vector<point> nearly{ sorted };
+            forn(k,NBPOINTS/2000) swap(nearly[rng()%NBPOINTS], nearly[rng()%NBPOINTS]);
+            bench(data[i], "random, long double");
+            bench(convert_points<double>(data[i]), "random, double");
+            bench(sorted, "sorted, long double");
+            bench(nearly, "nearly sorted, long double");
+        }
+    #endif
+
+    #ifdef PERF_GENERATORS
+        using wall_clock = chrono::steady_clock;
+        // Time to generate each dataset on 1 thread and on all of them, which must give the same points,
+        // next to the time of the sweeping on it
+        write_datasets=false;
+        const uint64_t seed=rng();
+        const int nb_threads=thread::hardware_concurrency();
+        forn(d,NB_DATASETS){
+            char dataset='A'+d;
+            auto start=wall_clock::now();
+            vector<point> serial{ gen_dataset(dataset, NBPOINTS, seed, 1) };
+            chrono::duration<double> serial_time=wall_clock::now()-start;
+            start=wall_clock::now();
+            vector<point> parallel{ gen_dataset(dataset, NBPOINTS, seed, nb_threads) };
+            chrono::duration<double> parallel_time=wall_clock::now()-start;
+            bool same=(serial==parallel);
+            start=wall_clock::now();
+            size_t hull_size=convex_hull_sweeping(serial).size();
+            chrono::duration<double> hull_time=wall_clock::now()-start;
+            cerr<<"Dataset "<<dataset<<" ("<<NBPOINTS<<" points) : generated in "<<serial_time.count()<<" s on 1 thread, ";
+            cerr<<parallel_time.count()<<" s on "<<nb_threads<<" threads ("<<(same ? "same points" : "DIFFERENT POINTS");
+            sort(all(parallel), point_cmp<ld>);
+            cerr<<"), "<<parallel.end()-unique(all(parallel))<<" duplicates, hull of "<<hull_size<<" points in "<<hull_time.count()<<" s\n";
+        }
+    #endif
+
+    #ifdef PERF_SIMD
+        using wall_clock = chrono::steady_clock;
+        // Each kernel on double coordinates with every instruction set the CPU has, against the scalar
+        // loops. The results must not depend on the instruction set.
+        auto time_of=[](auto&& f){
+            auto start=wall_clock::now();
+            f();
+            return chrono::duration<double>(wall_clock::now()-start).count();
+        };
+        const simd_level best=simd_dispatch;
+        for (char dataset : {'B', 'C'}){
+            vector<basic_point<double>> points{ convert_points<double>(dataset=='B' ? genB(NBPOINTS) : genC(NBPOINTS)) };
+            int n=points.size();
+            cerr<<"Dataset "<<dataset<<" ("<<n<<" points)\n";
+            basic_point<double> a(0.1, 0.45), b(0.9, 0.55);
+
+            vector<int8_t> reference(n), signs(n);
+            double scalar_time=time_of([&](){ forn(i,n) reference[i]=orient_filtered(a, b, points[i]); });
+            cerr<<"    orientation, scalar loop : "<<scalar_time<<" s\n";
+            pair<int,int> reference_extremes;
+            double extremes_time=time_of([&](){
+                reference_extremes={ min_element(all(points))-points.begin(), max_element(all(points))-points.begin() };
+            });
+            cerr<<"    extremes, min_element and max_element : "<<extremes_time<<" s\n";
+            vector<basic_point<double>> reference_filtered{ points };
+            simd_dispatch=SIMD_SCALAR;
+            double filter_time=time_of([&](){ akl_toussaint_filter(reference_filtered, 1); });
+            vector<basic_point<double>> reference_hull;
+            double dnc_time=time_of([&](){ Algorithm2<double> tmp(points); reference_hull=tmp.startAlgorithm(); });
+            cerr<<"    Akl-Toussaint filter, scalar : "<<filter_time<<" s, divide and conquer, scalar : "<<dnc_time<<" s\n";
+
+            for (int level=SIMD_SSE2; level<=best; level++){
+                simd_dispatch=(simd_level)level;
+                cerr<<"  "<<SIMD_NAMES[level]<<" :\n";
+                double time=time_of([&](){ orient_batch(a, b, points.data(), n, signs.data()); });
+                cerr<<"    orientation : "<<time<<" s (x"<<scalar_time/time<<"), "<<(signs==reference ? "same signs" : "DIFFERENT SIGNS")<<"\n";
+                pair<int,int> extremes;
+                time=time_of([&](){ extremes=extreme_points(points.data(), n); });
+                cerr<<"    extremes : "<<time<<" s (x"<<extremes_time/time<<"), "<<(extremes==reference_extremes ? "same points" : "DIFFERENT POINTS")<<"\n";
+                vector<basic_point<double>> filtered{ points };
+                time=time_of([&](){ akl_toussaint_filter(filtered, 1); });
+                cerr<<"    Akl-Toussaint filter : "<<time<<" s (x"<<filter_time/time<<"), "<<(filtered==reference_filtered ? "same points" : "DIFFERENT POINTS")<<"\n";
+                vector<basic_point<double>> hull;
+                time=time_of([&](){ Algorithm2<double> tmp(points); hull=tmp.startAlgorithm(); });
+                cerr<<"    divide and conquer : "<<time<<" s (x"<<dnc_time/time<<"), "<<(hull==reference_hull ? "same hull" : "DIFFERENT HULL")<<"\n";
+            }
+            simd_dispatch=best;
+        }
+    #endif
+
+    #ifdef PERF_BATCH
+        using wall_clock = chrono::steady_clock;
+        // Groups of random sizes taken from dataset B, solved one call of convex_hull_sweeping at a time
+        // or by the batch API on 1 and on all the threads
+        for (auto [min_size, max_size] : {pair(10, 20), pair(10, 500)}){
+            vector<point> points{ genB(NBPOINTS) };
+            vector<size_t> offsets{ 0 };
+            while (offsets.back()<points.size())
+                offsets.push_back(min(points.size(), offsets.back()+min_size+rng()%(max_size-min_size+1)));
+            int nb_groups=offsets.size()-1;
+            cerr<<nb_groups<<" groups of "<<min_size<<" to "<<max_size<<" points ("<<NBPOINTS<<" points)\n";
+
+            auto start=wall_clock::now();
+            vector<point> reference;
+            vector<size_t> reference_offsets{ 0 };
+            forn(g,nb_groups){
+                vector<point> group(points.begin()+offsets[g], points.begin()+offsets[g+1]);
+                vector<point> hull{ convex_hull_sweeping(group) };
+                reference.insert(reference.end(), all(hull));
+                reference_offsets.push_back(reference.size());
+            }
+            chrono::duration<double> time=wall_clock::now()-start;
+            cerr<<"    one call per group : "<<time.count()<<" s\n";
+
+            for (int nb_threads : {1, (int)thread::hardware_concurrency()}){
+                vector<point> hulls;
+                vector<size_t> hull_offsets;
+                start=wall_clock::now();
+                convex_hull_batch(points, offsets, hulls, hull_offsets, nb_threads);
+                time=wall_clock::now()-start;
+                cerr<<"    batch, "<<nb_threads<<" thread(s) : "<<time.count()<<" s, ";
+                cerr<<(hulls==reference && hull_offsets==reference_offsets ? "same hulls" : "DIFFERENT HULLS")<<"\n";
+            }
+        }
+    #endif
+
+    #ifdef PERF_IO
+        using wall_clock = chrono::steady_clock;
+        // Dataset B written and loaded back in both formats. The hull is computed on the loaded
+        // points (or directly on the mapping) to compare loading with the work that follows.
+        cerr<<NBPOINTS<<" points of dataset B\n";
+        vector<point> points{ genB(NBPOINTS) };
+        auto timed=[&](const char* name, auto&& f){
+            auto start=wall_clock::now();
+            f();
+            chrono::duration<double> time=wall_clock::now()-start;
+            cerr<<"    "<<setw(24)<<left<<name<<right<<" : "<<time.count()<<" s\n";
+        };
+        vector<point> loaded, hull_memory, hull_loaded, hull_mapped;
+        timed("write text (iostream)", [&](){
+            ofstream out("datasetB.txt");
+            out<<fixed<<setprecision(PRECISION);
+            for (const auto& p : points) out<<p.x<<" "<<p.y<<"\n";
+        });
+        timed("write text", [&](){ write_points_text("datasetB.txt", points); });
+        timed("write binary", [&](){ write_points("datasetB.bin", points); });
+        timed("load text (iostream)", [&](){
+            ifstream in("datasetB.txt");
+            loaded.clear();
+            ld x,y;
+            while (in>>x>>y) loaded.push_back({x,y});
+        });
+        timed("load text", [&](){ loaded=load_points_text<ld>("datasetB.txt"); });
+        timed("load binary", [&](){ loaded=load_points<ld>("datasetB.bin"); });
+        timed("map binary", [&](){ mapped_points<ld> mapped("datasetB.bin"); });
+        timed("hull in memory", [&](){ vector<point> input{ points }; hull_memory=convex_hull_sweeping(input); });
+        timed("load binary + hull", [&](){ loaded=load_points<ld>("datasetB.bin"); hull_loaded=convex_hull_sweeping(loaded); });
+        timed("map binary + hull", [&](){ mapped_points<ld> mapped("datasetB.bin"); hull_mapped=convex_hull_sweeping(mapped); });
+        struct stat text_info, binary_info;
+        stat("datasetB.txt", &text_info);
+        stat("datasetB.bin", &binary_info);
+        cerr<<"File sizes : text "<<text_info.st_size/1024<<" KiB, binary "<<binary_info.st_size/1024<<" KiB\n";
+        // Round trip : the text read back and written again with the same precision gives the same file
+        write_points_text("datasetB_copy.txt", load_points_text<ld>("datasetB.txt"));
+        ifstream original("datasetB.txt"), copy("datasetB_copy.txt");
+        bool same_text=equal(istreambuf_iterator<char>(original), istreambuf_iterator<char>(), istreambuf_iterator<char>(copy), istreambuf_iterator<char>());
+        cerr<<"Text round trip : "<<(same_text ? "same file" : "DIFFERENT FILES")<<"\n";
+        cerr<<(hull_loaded==hull_memory && hull_mapped==hull_memory ? "same hulls" : "DIFFERENT HULLS")<<"\n";
+    #endif
+
+    #ifdef PERF_STREAMING
+        using wall_clock = chrono::steady_clock;
+        // The file is written chunk by chunk, so the streaming runs never hold all the points. The
+        // in-memory run comes last since it raises the peak memory of the process.
+        const char* filename="points.bin";
+        cerr<<"Hulls of files of "<<NBPOINTS<<" points ("<<NBPOINTS*sizeof(basic_point<double>)/(1<<20)<<" MiB), read by chunks of "<<STREAM_CHUNK<<" points\n";
+        forn(i,2){
+            for (int first=0; first<NBPOINTS; first+=STREAM_CHUNK){
+                int nb=min((int)STREAM_CHUNK, NBPOINTS-first);
+                write_points(filename, convert_points<double>(i==0 ? genB(nb) : genC(nb)), first>0);
+            }
+            cerr<<"Dataset "<<(char)('B'+i)<<" :\n";
+            struct rusage usage;
+            auto start=wall_clock::now();
+            vector<basic_point<double>> res_mmap{ convex_hull_streaming<double>(filename) };
+            chrono::duration<double> time=wall_clock::now()-start;
+            cerr<<"    streaming, mmap  : "<<time.count()<<" s\n";
+            start=wall_clock::now();
+            vector<basic_point<double>> res_read{ convex_hull_streaming<double>(filename, STREAM_CHUNK, false) };
+            time=wall_clock::now()-start;
+            cerr<<"    streaming, read  : "<<time.count()<<" s\n";
+            getrusage(RUSAGE_SELF, &usage);
+            cerr<<"    peak RSS after the streaming runs : "<<usage.ru_maxrss<<" KiB\n";
+            start=wall_clock::now();
+            vector<basic_point<double>> points{ load_points<double>(filename) };
+            vector<basic_point<double>> res_memory{ convex_hull_sweeping(points) };
+            time=wall_clock::now()-start;
+            cerr<<"    in memory        : "<<time.count()<<" s\n";
+            getrusage(RUSAGE_SELF, &usage);
+            cerr<<"    peak RSS after the in-memory run  : "<<usage.ru_maxrss<<" KiB\n";
+            bool same=(res_mmap==res_memory && res_read==res_memory);
+            cerr<<"    "<<(same ? "same hulls" : "DIFFERENT HULLS")<<" ("<<res_memory.size()<<" points)\n";
+        }
+        remove(filename);
     #endif
 
     #ifdef SAMPLE
-        data[0]=genA(NBPOINTS);
-        data[1]=genB(NBPOINTS);
-        data[2]=genC(NBPOINTS);
-        data[3]=genD(NBPOINTS);
+        forn(i,NB_DATASETS) data[i]=gen_dataset('A'+i, NBPOINTS);
         freopen("results.txt", "w", stdout);
         cout<<"Successfully generated datasets after ";
         cout<<clock()*1.0/CLOCKS_PER_SEC;
         cout<<" seconds\n";
-        vector<point> res[4];
-        vector<point> res2[4];
-        forn(i,4){
+        vector<point> res[NB_DATASETS];
+        vector<point> res2[NB_DATASETS];
+        vector<point> res3[NB_DATASETS];
+        vector<point> res4[NB_DATASETS];
+        vector<point> res5[NB_DATASETS];
+        vector<point> res6[NB_DATASETS];
+        vector<point> res7[NB_DATASETS];
+        forn(i,NB_DATASETS){
+            #ifdef PREFILTER
+                cerr<<"Prefilter discarded "<<akl_toussaint_filter(data[i])<<" points of dataset "<<(char)('A'+i)<<"\n";
+            #endif
             res[i]=convex_hull_sweeping(data[i]);
             Algorithm2 tmp(data[i]);
             res2[i]=tmp.startAlgorithm();
-            if (res[i].size()+1==res2[i].size()) res2[i].pop_back();
+            res3[i]=convex_hull_chan(data[i]);
+            Algorithm2 tmp_in_place(data[i]);
+            res4[i]=tmp_in_place.startAlgorithmInPlace();
+            Algorithm2 tmp_parallel(data[i]);
+            res5[i]=tmp_parallel.startAlgorithmParallel();
+            DynamicHull<ld> dynamic_hull;
+            for (const auto& p : data[i]) dynamic_hull.insert(p);
+            res6[i]=dynamic_hull.hull();
+            res7[i]=convex_hull_quickhull(data[i]);
+        }
+        forn(i,NB_DATASETS) write_points((string("results")+(char)('A'+i)+".bin").c_str(), res2[i]);
+        // The same files in text, for the tools that do not read the binary format
+        forn(i,NB_DATASETS){
+            write_points_text((string("dataset")+(char)('A'+i)+".txt").c_str(), data[i]);
+            write_points_text((string("results")+(char)('A'+i)+".txt").c_str(), res2[i]);
         }
-        freopen("resultsA.txt", "w", stdout);
-        for (auto pt : res2[0]) cout<<pt.x<<" "<<pt.y<<"\n";
-        freopen("resultsB.txt", "w", stdout);
-        for (auto pt : res2[1]) cout<<pt.x<<" "<<pt.y<<"\n";
-        freopen("resultsC.txt", "w", stdout);
-        for (auto pt : res2[2]) cout<<pt.x<<" "<<pt.y<<"\n";
-        freopen("resultsD.txt", "w", stdout);
-        for (auto pt : res2[3]) cout<<pt.x<<" "<<pt.y<<"\n";
 
         freopen("results.txt", "w", stdout);
-        cout<<"Do both algorithms return the same result ? \n";
-        forn(i,4){
-            cout<<"Running on dataset "<<(char)('A'+i)<<" : ";
-            set<pair<ld,ld>> st;
-            bool ok=true;
-            if (res[i].size() != res2[i].size()){
-                cout<<"The sizes of hulls returned are different ("<<res[i].size()<<" vs "<<res2[i].size()<<")\n";
-                continue;
-            }
-            for (auto pt : res[i]){
-                st.insert({pt.x, pt.y});
-            }
-            for (auto [a,b] : res2[i]){
-                if (st.find({a,b})==st.end()){
-                    cout<<fixed<<setprecision(PRECISION)<<"Couldn't find point ("<<a<<","<<b<<") in the sweeping hull\n";
-                    ok=false;
+        cout<<"Do the algorithms return the same result as the sweeping ? \n";
+        // With 'same_order', the hull must also be in the order of the sweeping
+        auto compare = [&](const char* name, vector<point>* other, bool same_order=false){
+            cout<<name<<" :\n";
+            forn(i,NB_DATASETS){
+                cout<<"Running on dataset "<<(char)('A'+i)<<" : ";
+                set<pair<ld,ld>> st;
+                bool ok=true;
+                if (res[i].size() != other[i].size()){
+                    cout<<"The sizes of hulls returned are different ("<<res[i].size()<<" vs "<<other[i].size()<<")\n";
+                    continue;
+                }
+                if (same_order){
+                    if (res[i]==other[i]) cout<<"OK, hulls are the same\n";
+                    else cout<<"Hulls are different or not in the same order\n";
+                    continue;
+                }
+                for (auto pt : res[i]){
+                    st.insert({pt.x, pt.y});
                 }
+                for (auto [a,b] : other[i]){
+                    if (st.find({a,b})==st.end()){
+                        cout<<fixed<<setprecision(PRECISION)<<"Couldn't find point ("<<a<<","<<b<<") in the sweeping hull\n";
+                        ok=false;
+                    }
+                }
+                if (ok) cout<<"OK, hulls are the same\n";
+                else cout<<"Hulls are different\n";
             }
-            if (ok) cout<<"OK, hulls are the same\n";
-            else cout<<"Hulls are different\n";
-        }
+        };
+        compare("Divide and conquer", res2);
+        compare("Chan", res3, true);
+        compare("Divide and conquer in place", res4);
+        compare("Divide and conquer in parallel", res5);
+        compare("Dynamic hull", res6);
+        compare("Quickhull", res7, true);
     #endif
 }
+#endif
@@ -1,13 +1,39 @@
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <type_traits>
 #include <iostream>
+#include <fstream>
 #include <iomanip>
 #include <random>
 #include <cassert>
 #include <vector>
 #include <algorithm>
+#include <numeric>
 #include <tuple>
 #include <set>
+#include <array>
+#include <memory>
+#include <sys/resource.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <chrono>
+#include <charconv>
+#include <future>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __x86_64__
+    #include <immintrin.h>
+#endif
 
 using namespace std;
 
@@ -22,8 +48,34 @@ mt19937 rng(time(0)); //Random number generator of 32 bits. It is better than ra
 // Constants
 
 const int PRECISION=12;
-#ifdef PERF
+#if defined(PERF_LAYOUT)
     const int NBPOINTS=3e4;
+#elif defined(PERF_ALLOC)
+    const int NBPOINTS=3e5;
+#elif defined(PERF_PARALLEL)
+    const int NBPOINTS=4e6;
+#elif defined(PERF_DYNAMIC)
+    const int NBPOINTS=1e5;
+#elif defined(PERF_IO)
+    const int NBPOINTS=1e6;
+#elif defined(PERF_QUERIES)
+    const int NBPOINTS=1e6;
+#elif defined(PERF_LAYERS)
+    const int NBPOINTS=1e6;
+#elif defined(PERF_WINDOW)
+    const int NBPOINTS=1e6;
+#elif defined(PERF_INTEGER)
+    const int NBPOINTS=4e6;
+#elif defined(PERF_SORT)
+    const int NBPOINTS=4e6;
+#elif defined(PERF_GENERATORS)
+    const int NBPOINTS=4e6;
+#elif defined(PERF_SIMD)
+    const int NBPOINTS=4e6;
+#elif defined(PERF_BATCH)
+    const int NBPOINTS=4e6;
+#elif defined(PERF_STREAMING)
+    const int NBPOINTS=1e7;
 #else   
     const int NBPOINTS=100;
 #endif
@@ -35,28 +87,231 @@ const int VLENGTH = 800;
 
 // Structs 
 
-struct point{
-    ld x,y;
+template <typename T>
+struct basic_point{
+    T x,y;
+
+    basic_point() = default;
 
-    point(ld x, ld y): x{ x }, y{ y } {}
+    basic_point(T x, T y): x{ x }, y{ y } {}
 
-    point operator+(point other) {
-        return point(x + other.x, y + other.y);
+    basic_point operator+(const basic_point& other) const {
+        return basic_point(x + other.x, y + other.y);
     }
 
-    point operator-(point other) {
-        return point(x - other.x, y - other.y);
+    basic_point operator-(const basic_point& other) const {
+        return basic_point(x - other.x, y - other.y);
     }
 
-    bool operator<(point other) {
-        return x < other.x;
+    // Lexicographic order : by x, then by y
+    bool operator<(const basic_point& other) const {
+        return x < other.x || (x == other.x && y < other.y);
     }
 
-    bool operator==(point other) {
+    bool operator==(const basic_point& other) const {
         return x == other.x && y == other.y;
     }
 
-    point operator/(ld z){
+    basic_point operator/(T z) const {
         return {x/z, y/z};
     }
-};
\ No newline at end of file
+};
+
+using point = basic_point<ld>; // Default scalar, the one used by the generators
+
+// Structure-of-arrays layout : the x and y coordinates are stored in two separate buffers
+template <typename T>
+struct point_soa{
+    vector<T> x,y;
+
+    point_soa() {}
+
+    point_soa(const vector<basic_point<T>>& points){
+        x.reserve(points.size());
+        y.reserve(points.size());
+        for (const auto& p : points) push_back(p);
+    }
+
+    size_t size() const {
+        return x.size();
+    }
+
+    basic_point<T> operator[](size_t i) const {
+        return {x[i], y[i]};
+    }
+
+    void push_back(const basic_point<T>& p){
+        x.push_back(p.x);
+        y.push_back(p.y);
+    }
+};
+
+// Binary point files : a 64 bytes header followed by the raw array of basic_point<T>, so that the
+// points can be memory-mapped and used in place
+enum scalar_type : uint32_t { SCALAR_FLOAT=1, SCALAR_DOUBLE=2, SCALAR_LONG_DOUBLE=3, SCALAR_INT32=4, SCALAR_INT64=5 };
+
+template <typename T>
+constexpr scalar_type scalar_code(){
+    static_assert(is_same_v<T,float> || is_same_v<T,double> || is_same_v<T,ld> || is_same_v<T,int32_t> || is_same_v<T,int64_t>,
+                  "Unsupported scalar type");
+    if constexpr (is_same_v<T,float>) return SCALAR_FLOAT;
+    else if constexpr (is_same_v<T,double>) return SCALAR_DOUBLE;
+    else if constexpr (is_same_v<T,int32_t>) return SCALAR_INT32;
+    else if constexpr (is_same_v<T,int64_t>) return SCALAR_INT64;
+    else return SCALAR_LONG_DOUBLE;
+}
+
+struct point_file_header{
+    char magic[8];          // "CHULLPTS"
+    uint32_t scalar;        // scalar_type of the coordinates
+    uint32_t point_size;    // sizeof(basic_point<T>), long double differs between platforms
+    uint64_t count;         // Number of points
+    double min_x, min_y, max_x, max_y; // Bounding box, rounded to double
+    char padding[8];        // Keeps the points aligned for every scalar type
+};
+static_assert(sizeof(point_file_header)==64, "The point file header must be 64 bytes");
+
+// Converts points from one scalar type to another (e.g. the long double generators to float)
+template <typename U, typename T>
+vector<basic_point<U>> convert_points(const vector<basic_point<T>>& points){
+    vector<basic_point<U>> res;
+    res.reserve(points.size());
+    for (const auto& p : points) res.push_back({(U)p.x, (U)p.y});
+    return res;
+}
+
+// Fixed-point coordinates : integer points (int32_t or int64_t) on a square grid, the point (i, j)
+// standing for (origin_x + i*step, origin_y + j*step). The predicates are exact on integers, without
+// any fallback (see orient_sign). int64_t coordinates must stay below 2^62 in absolute value.
+struct quantization{
+    ld origin_x=0, origin_y=0, step=1;
+
+    template <typename I>
+    basic_point<ld> restore(const basic_point<I>& p) const {
+        return {origin_x+step*p.x, origin_y+step*p.y};
+    }
+};
+
+template <typename I>
+quantization make_grid(ld min_x, ld min_y, ld max_x, ld max_y, int bits){
+    // Grid of 2^bits cells on the largest side of the bounding box, the same step on both axes
+    static_assert(is_integral_v<I>, "Quantized coordinates are integers");
+    assert(bits>0 && bits<=min(numeric_limits<I>::digits, 62));
+    quantization grid;
+    grid.origin_x=min_x;
+    grid.origin_y=min_y;
+    ld side=max(max_x-min_x, max_y-min_y);
+    grid.step=side>0 ? side/(ld)((1LL<<bits)-1) : 1;
+    return grid;
+}
+
+template <typename I, typename T>
+void quantize_points(const basic_point<T>* first, const basic_point<T>* last, basic_point<I>* out, const quantization& grid){
+    // Rounds each point to the nearest point of the grid
+    const ld top=(ld)numeric_limits<I>::max();
+    auto round_to_grid=[&](ld v, ld origin){ return (I)min(top, max((ld)0, roundl((v-origin)/grid.step))); };
+    for (const basic_point<T>* p=first; p!=last; ++p, ++out) *out={round_to_grid(p->x, grid.origin_x), round_to_grid(p->y, grid.origin_y)};
+}
+
+template <typename I, typename T>
+vector<basic_point<I>> quantize_points(const vector<basic_point<T>>& points, int bits, quantization* used_grid=nullptr){
+    // Quantizes 'points' on a grid of 2^bits cells fitted to their bounding box, returned in 'used_grid'
+    ld min_x=0, min_y=0, max_x=0, max_y=0;
+    if (!points.empty()){
+        min_x=max_x=points[0].x;
+        min_y=max_y=points[0].y;
+    }
+    for (const auto& p : points){
+        min_x=min<ld>(min_x, p.x); max_x=max<ld>(max_x, p.x);
+        min_y=min<ld>(min_y, p.y); max_y=max<ld>(max_y, p.y);
+    }
+    quantization grid=make_grid<I>(min_x, min_y, max_x, max_y, bits);
+    if (used_grid) *used_grid=grid;
+    vector<basic_point<I>> res(points.size());
+    quantize_points(points.data(), points.data()+points.size(), res.data(), grid);
+    return res;
+}
+
+// Instrumentation of the hull algorithms : wall time of each phase and counts of the hot-path
+// operations. It is compiled in with -DHULL_STATS only, otherwise the STATS_* macros are empty.
+// In the parallel algorithms the times of the threads add up.
+struct hull_stats{
+    // Seconds spent in each phase
+    double sort=0, chains=0, median=0, bridge=0, partition=0, prefilter=0;
+    long long orient_tests=0;    // Calls to orient_sign
+    long long pops=0;            // Points popped from the chains of the sweeping
+    long long max_depth=0;       // Deepest recursion of Algorithm2
+    long long bytes_allocated=0; // Heap bytes allocated by every thread
+    long long pruned=0;          // Points discarded by the Akl-Toussaint prefilter
+
+    hull_stats& operator+=(const hull_stats& other){
+        sort+=other.sort; chains+=other.chains; median+=other.median;
+        bridge+=other.bridge; partition+=other.partition; prefilter+=other.prefilter;
+        orient_tests+=other.orient_tests; pops+=other.pops; max_depth=max(max_depth, other.max_depth);
+        bytes_allocated+=other.bytes_allocated; pruned+=other.pruned;
+        return *this;
+    }
+};
+
+#ifdef HULL_STATS
+    enum stats_phase { PHASE_SORT, PHASE_CHAINS, PHASE_MEDIAN, PHASE_BRIDGE, PHASE_PARTITION, PHASE_PREFILTER, NB_PHASES };
+
+    // Counters updated by the algorithms, shared by all the threads
+    struct stats_counters{
+        atomic<long long> phase_ns[NB_PHASES];
+        atomic<long long> orient_tests, pops, max_depth, bytes_allocated, pruned;
+    };
+    inline stats_counters counters{};
+
+    // Adds the lifetime of the timer to a phase
+    struct phase_timer{
+        stats_phase phase;
+        chrono::steady_clock::time_point start=chrono::steady_clock::now();
+
+        ~phase_timer(){
+            counters.phase_ns[phase].fetch_add(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now()-start).count(), memory_order_relaxed);
+        }
+    };
+
+    inline void stats_depth(long long depth){
+        long long deepest=counters.max_depth.load(memory_order_relaxed);
+        while (depth>deepest && !counters.max_depth.compare_exchange_weak(deepest, depth, memory_order_relaxed)) {}
+    }
+
+    #define STATS_ADD(counter, n) counters.counter.fetch_add(n, memory_order_relaxed)
+    #define STATS_TIMER(phase) phase_timer stats_timer{ phase }
+    #define STATS_DEPTH(depth) stats_depth(depth)
+#else
+    #define STATS_ADD(counter, n) ((void)0)
+    #define STATS_TIMER(phase) ((void)0)
+    #define STATS_DEPTH(depth) ((void)0)
+#endif
+
+// Resets the counters, to be called before a run
+inline void reset_stats(){
+    #ifdef HULL_STATS
+        for (auto& ns : counters.phase_ns) ns=0;
+        counters.orient_tests=counters.pops=counters.max_depth=counters.bytes_allocated=counters.pruned=0;
+    #endif
+}
+
+// Counters since the last reset_stats(). All zero without HULL_STATS.
+inline hull_stats read_stats(){
+    hull_stats res;
+    #ifdef HULL_STATS
+        double* times[NB_PHASES]={&res.sort, &res.chains, &res.median, &res.bridge, &res.partition, &res.prefilter};
+        forn(i,NB_PHASES) *times[i]=counters.phase_ns[i]*1e-9;
+        res.orient_tests=counters.orient_tests;
+        res.pops=counters.pops;
+        res.max_depth=counters.max_depth;
+        res.bytes_allocated=counters.bytes_allocated;
+        res.pruned=counters.pruned;
+    #endif
+    return res;
+}
+
+inline void print_stats(ostream& out, const hull_stats& s){
+    out<<"sort "<<s.sort<<" s, chains "<<s.chains<<" s, median "<<s.median<<" s, bridge "<<s.bridge<<" s, ";
+    out<<"partition "<<s.partition<<" s, prefilter "<<s.prefilter<<" s, "<<s.orient_tests<<" orientation tests, ";
+    out<<s.pops<<" pops, depth "<<s.max_depth<<", "<<s.bytes_allocated/1024<<" KiB allocated, "<<s.pruned<<" pruned\n";
+}
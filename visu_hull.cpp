@@ -1,107 +1,36 @@
-#include "convex_hull.h"
-
-#include <SFML/Graphics.hpp>
-
+// Live visualization of the hull algorithms. The algorithms of convex_hull.cpp run with a trace_observer,
+// and the traces of their steps are replayed here : pushes and pops of the chains of the sweeping,
+// orientation tests, bridges of the divide and conquer.
+//
+// ./visu : traces the sweeping and the divide and conquer on dataset B (saved in trace_sweep.bin and
+//          trace_dnc.bin), then replays both
+// ./visu dataset.bin trace.bin... : replays saved traces on the points of dataset.bin
 
+#define CONVEX_HULL_LIBRARY // Everything but the main() of convex_hull.cpp
+#include "convex_hull.cpp"
 
-/* Part 2 : datasets*/
-
-// Functions to generate point datasets. After generation, points can be found in the "datasetX.txt" files
+#include <SFML/Graphics.hpp>
 
-ld random_double(){
-    // Generates a random ld by taking rng() (a 32 bits random integer generator), and dividing it by its maximum value (INT_MAX)
-    return ((ld)(rng())/((ld)(UINT32_MAX)));
+void draw_dot(sf::RenderWindow& window, const basic_point<float>& p, float radius, sf::Color color){
+    sf::CircleShape dot(radius);
+    dot.setFillColor(color);
+    dot.setPosition(p.x * HLENGTH - radius, p.y * VLENGTH - radius);
+    window.draw(dot);
 }
 
-vector<point> genA(int n){
-    // Generates n-4 points randomly in the [0,1]^2 square, and adds the corners. Applies a random rotation and a random shuffling
-    // The resulting points can be outside of [0,1]^2 but it doesn't matter. The center of rotation is chosen randomly in [0,1]^2
-    // If n<4, this function returns an error 
-    assert(n>=4 && "There are less than 4 points given to genA !");
-
-    vector<point> points; 
-    point rotation_center={random_double(), random_double()};
-    ld rotation_angle=random_double()*2.*M_PI;
-
-    // Define a lambda-function for the rotation (even though there is probably one somewhere in the stl)
-    auto rotate = [&](point pt){
-        point centerToPt={pt.x-rotation_center.x, pt.y-rotation_center.y}; // Take the vector from center to target point
-        ld c=cos(rotation_angle);
-        ld s=sin(rotation_angle);
-        point rotated={centerToPt.x*c-centerToPt.y*s, centerToPt.x*s+centerToPt.y*c}; //Apply the well-known rotation matrix Rtheta
-        rotated.x+=rotation_center.x; rotated.y+=rotation_center.y;
-        return rotated;
+void draw_segment(sf::RenderWindow& window, const basic_point<float>& a, const basic_point<float>& b, sf::Color color){
+    sf::Vertex line[] = {
+        sf::Vertex(sf::Vector2f(a.x * HLENGTH, a.y * VLENGTH), color),
+        sf::Vertex(sf::Vector2f(b.x * HLENGTH, b.y * VLENGTH), color)
     };
-    forn(i,n-4){
-        point cur_point={random_double(), random_double()};
-        points.push_back(rotate(cur_point));
-    }
-    vector<point> corners;
-    corners.push_back({0.,0.});
-    corners.push_back({1.,0.});
-    corners.push_back({0.,1.});
-    corners.push_back({1.,1.});
-    for (auto corner : corners){
-        points.push_back(rotate(corner));
-    }
-
-    shuffle(all(points), rng); // STL function to shuffle (I could do it myself by just n random positions)
-
-    freopen("datasetA.txt","w", stdout);
-    for (auto pt : points) cout<<fixed<<setprecision(PRECISION)<<pt.x<<" "<<pt.y<<"\n";
-    return points;
-}
-
-vector<point> genB(int n){
-    freopen("datasetB.txt","w", stdout);
-    vector<point> points;
-    forn(i,n){
-        ld x=random_double();
-        ld y=random_double();
-        points.push_back({x,y});
-        cout<<fixed<<setprecision(PRECISION)<<x<<" "<<y<<"\n"; 
-    }
-    return points;
-}
-
-vector<point> genC(int n){
-    // Using reject-accept algorithm in a circle
-    freopen("datasetC.txt","w", stdout);
-    vector<point> points;
-    while((int) points.size()<n){
-        ld x=random_double();
-        ld y=random_double();
-        double d = hypot(x-0.5, y-0.5);
-        if (d <=0.5){
-           // cout<<d<<"\n";
-            points.push_back({x,y});
-            cout<<fixed<<setprecision(PRECISION)<<x<<" "<<y<<"\n"; 
-        }
-    }
-    return points;
-}
-
-vector<point> genD(int n){
-    freopen("datasetD.txt","w", stdout);
-    vector<point> points;
-    forn(i,n){
-        ld theta=2.*M_PI*random_double();
-        ld x = 0.5*cos(theta)+0.5;
-        ld y = 0.5*sin(theta)+0.5;
-        cout<<fixed<<setprecision(PRECISION)<<x<<" "<<y<<"\n"; 
-        points.push_back({x,y});
-    }
-    return points;
+    window.draw(line, 2, sf::Lines);
 }
 
-/* Part 3 : Sweeping */
-
-ld cross(point a, point b){return a.x*b.y-a.y*b.x;}
-
 void draw_points(sf::RenderWindow& window,
-                 const vector<point>& all_points,
-                 const vector<point>& hull,
-                 const vector<point>& highlighted = {}) 
+                 const vector<basic_point<float>>& all_points,
+                 const vector<vector<basic_point<float>>>& chains,
+                 const vector<pair<basic_point<float>, basic_point<float>>>& bridges,
+                 const vector<basic_point<float>>& highlighted = {})
 {
     sf::Event event;
     while (window.pollEvent(event)) {
@@ -111,133 +40,89 @@ void draw_points(sf::RenderWindow& window,
     window.clear(sf::Color::White);
 
     // Draw all points in black
-    for (auto& p : all_points) {
-        sf::CircleShape dot(4);
-        dot.setFillColor(sf::Color::Black);
-        dot.setPosition(p.x * HLENGTH, p.y * VLENGTH);
-        window.draw(dot);
+    for (auto& p : all_points) draw_dot(window, p, 4, sf::Color::Black);
+
+    // Draw the chains in green, the last one is the current one
+    for (auto& chain : chains) {
+        for (int i = 0; i + 1 < (int)chain.size(); i++) draw_segment(window, chain[i], chain[i+1], sf::Color::Green);
+        for (auto& p : chain) draw_dot(window, p, 6, sf::Color::Green);
     }
 
-    // Draw hull points in green
-    for (auto& p : hull) {
-        sf::CircleShape dot(6);
-        dot.setFillColor(sf::Color::Green);
-        dot.setPosition(p.x * HLENGTH, p.y * VLENGTH);
-        window.draw(dot);
+    // Draw the bridges in blue
+    for (auto& [p1, p2] : bridges) {
+        draw_segment(window, p1, p2, sf::Color::Blue);
+        draw_dot(window, p1, 6, sf::Color::Blue);
+        draw_dot(window, p2, 6, sf::Color::Blue);
     }
 
     // Draw currently processed points in red
-    for (auto& p : highlighted) {
-        sf::CircleShape dot(8);
-        dot.setFillColor(sf::Color::Red);
-        dot.setPosition(p.x * HLENGTH, p.y * VLENGTH);
-        window.draw(dot);
-    }
+    for (auto& p : highlighted) draw_dot(window, p, 8, sf::Color::Red);
 
     window.display();
     sf::sleep(sf::milliseconds(40)); // Slow animation
 }
 
-
-bool orient(point a, point b, point c,
-            sf::RenderWindow& window,
-            const vector<point>& all_points,
-            const vector<point>& hull)
-{
-    draw_points(window, all_points, hull, {a, b, c});
-
-    point a_to_b = {b.x - a.x, b.y - a.y};
-    point a_to_c = {c.x - a.x, c.y - a.y};
-    return (cross(a_to_b, a_to_c) <= 0);
+void replay(sf::RenderWindow& window, const vector<basic_point<float>>& points, const vector<trace_event>& trace){
+    vector<vector<basic_point<float>>> chains;
+    vector<pair<basic_point<float>, basic_point<float>>> bridges;
+    for (const auto& e : trace) {
+        if (!window.isOpen())
+            return;
+        switch (e.type)
+        {
+        case TRACE_CHAIN:
+            chains.emplace_back();
+            continue; // Nothing to draw yet
+        case TRACE_PUSH:
+            chains.back().push_back(e.points[0]);
+            draw_points(window, points, chains, bridges);
+            break;
+        case TRACE_POP:
+            chains.back().pop_back();
+            draw_points(window, points, chains, bridges);
+            break;
+        case TRACE_ORIENT:
+            draw_points(window, points, chains, bridges, {e.points[0], e.points[1], e.points[2]});
+            break;
+        case TRACE_BRIDGE:
+            bridges.push_back({e.points[0], e.points[1]});
+            draw_points(window, points, chains, bridges);
+            break;
+        }
+    }
 }
 
-vector<point> convex_hull_sweeping(vector<point>& points,
-                                   sf::RenderWindow& window){
-    sort(all(points), [](const point a, const point b){
-        if (a.x==b.x) return a.y<b.y;
-        return a.x<b.x;
-    }); // Sort points by increasing x using a lambda function
-    int n=points.size();
-    vector<point> hull_up;
-    vector<point> hull_down;
-    // Increasing x pass
-    forn(i,n){
-        if(hull_up.size()<=1){ // If there are 0 or 1 points in the hull
-            hull_up.push_back(points[i]);
-            draw_points(window, points, hull_up);
+int main(int argc, char** argv) {
+    vector<point> points;
+    vector<vector<trace_event>> traces;
+    try {
+        if (argc >= 3) {
+            points = load_points<ld>(argv[1]);
+            for (int i = 2; i < argc; i++) traces.push_back(load_trace(argv[i]));
         }
-        else{
-            // Compare orientation with the two previous points
-            point a=hull_up[hull_up.size()-2];
-            point b=hull_up[hull_up.size()-1];
-            point c=points[i];
-            if (orient(a,b,c,window,points,hull_up)){
-                // If clockwise, meaning c is to the right side of b
-                hull_up.push_back(c);
-                draw_points(window, points, hull_up);
-            }
-            else{
-                while(!orient(a,b,c,window,points,hull_up) && (int)(hull_up.size())>=3){
-                    hull_up.pop_back(); // Remove the last point of the hull
-                    b=hull_up[hull_up.size()-1];
-                    a=hull_up[hull_up.size()-2];
-                    draw_points(window, points, hull_up);
-                }
-                if (!orient(a,b,c,window,points,hull_up)){
-                    hull_up.pop_back();
-                    draw_points(window, points, hull_up);
-                }
-                hull_up.push_back(c);
-                draw_points(window, points, hull_up);
-            }
+        else {
+            points = genB(NBPOINTS);
+
+            trace_observer sweep_trace;
+            vector<point> input{ points };
+            convex_hull_sweeping(input, sweep_trace);
+            sweep_trace.save("trace_sweep.bin");
+            traces.push_back(read_trace(sweep_trace.data()));
+
+            Algorithm2<ld, trace_observer> dnc(points);
+            dnc.startAlgorithm();
+            dnc.getObserver().save("trace_dnc.bin");
+            traces.push_back(read_trace(dnc.getObserver().data()));
         }
     }
-    // Decreasing x pass. If everything went well the rightmost point and leftmost point are in the hull so it's no use to consider them
-    for(int i=n-1;i>=0;i--){ 
-        if(hull_down.size()<=1){
-            hull_down.push_back(points[i]);
-            draw_points(window, points, hull_down);
-        }
-        else{
-            point a=hull_down[hull_down.size()-2];
-            point b=hull_down[hull_down.size()-1];
-            point c=points[i];
-            if (orient(a,b,c,window,points,hull_down)){
-                hull_down.push_back(c);
-                draw_points(window, points, hull_down);
-            }
-            else{
-                while(!orient(a,b,c,window,points,hull_down) && (int)(hull_down.size())>=3){
-                    hull_down.pop_back(); 
-                    b=hull_down[hull_down.size()-1];
-                    a=hull_down[hull_down.size()-2];
-                    draw_points(window, points, hull_down);
-                }
-                if (!orient(a,b,c,window,points,hull_down)){
-                    hull_down.pop_back();
-                    draw_points(window, points, hull_down);
-                }
-                hull_down.push_back(c);
-                draw_points(window, points, hull_down);
-            }
-        }
+    catch (const exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
     }
-    vector<point> final_hull = hull_up;
-
-    for (int j = 1; j < (int)hull_down.size() - 1; j++)
-        final_hull.push_back(hull_down[j]);
-
-    draw_points(window, points, final_hull);
-    return final_hull;
-}
-
-int main() {
-
-    auto points = genB(NBPOINTS);
 
     sf::RenderWindow window(sf::VideoMode(HLENGTH, VLENGTH), "Convex Hull Visualizer");
-
-    auto hull = convex_hull_sweeping(points, window);
+    vector<basic_point<float>> shown{ convert_points<float>(points) };
+    for (const auto& trace : traces) replay(window, shown, trace);
 
     // Keep window open after animation
     while (window.isOpen()) {
@@ -1,28 +1,35 @@
+import struct
+import numpy as np
 import matplotlib.pyplot as plt
 
+# Scalar codes of the binary point files (scalar_type in convex_hull.h)
+SCALARS = {1: np.float32, 2: np.float64, 3: np.longdouble}
+
+def read_points(f):
+    # 64 bytes header : magic, scalar type, size of a point, number of points, bounding box
+    with open(f, 'rb') as st:
+        header = st.read(64)
+        scalar, point_size, count = struct.unpack_from('<IIQ', header, 8)
+        points = np.frombuffer(st.read(count * point_size), dtype=SCALARS[scalar]).reshape(count, 2)
+        return points[:, 0].astype(float), points[:, 1].astype(float)
+
 def draw_input_from_file(f, ax):
-    with open(f) as st:
-        lines = st.readlines()
-        x = [float(line.split()[0]) for line in lines]
-        y = [float(line.split()[1]) for line in lines]
-        ax.plot(x, y, "ob")
-
-def draw_output(ax, f='resultsC.txt'):
-    with open(f) as st:
-        lines = st.readlines()
-        x = [float(line.split()[0]) for line in lines]
-        y = [float(line.split()[1]) for line in lines]
-        ax.plot(x, y, "or")
-        print(len(x))
-        for i in range(len(x)-1):
-            ax.plot([x[i], x[i+1]], [y[i], y[i+1]], "r")
-        ax.plot([x[-1], x[0]], [y[-1], y[0]], "r")
-
-# Create 2x2 subplot grid
-fig, axes = plt.subplots(2, 2, figsize=(10, 10))
-
-datasets = ['datasetA.txt', 'datasetB.txt', 'datasetC.txt', 'datasetD.txt']
-results = ['resultsA.txt', 'resultsB.txt', 'resultsC.txt', 'resultsD.txt']
+    x, y = read_points(f)
+    ax.plot(x, y, "ob")
+
+def draw_output(ax, f='resultsC.bin'):
+    x, y = read_points(f)
+    ax.plot(x, y, "or")
+    print(len(x))
+    for i in range(len(x)-1):
+        ax.plot([x[i], x[i+1]], [y[i], y[i+1]], "r")
+    ax.plot([x[-1], x[0]], [y[-1], y[0]], "r")
+
+# Create 2x4 subplot grid : datasets A to D, then the stress datasets E to H
+fig, axes = plt.subplots(2, 4, figsize=(20, 10))
+
+datasets = [f'dataset{c}.bin' for c in 'ABCDEFGH']
+results = [f'results{c}.bin' for c in 'ABCDEFGH']
 
 for ax, data, result in zip(axes.flatten(), datasets, results):
     draw_input_from_file(data, ax)